@@ -7,7 +7,11 @@ const CP437_SECTION_ATTRIBUTE struct text_mode_font cp437 = (text_mode_font)
     CP437_FONT_HEIGHT, // scan_lines
     sizeof(CP437_DATA_TYPE), // bytes_per_scan
     sizeof(CP437_DATA_TYPE) * CP437_FONT_HEIGHT, // bytes_per_glyph
-    (void* const)&cp437_bitmaps[0][0][0] // data
+    (void* const)&cp437_bitmaps[0][0][0], // data
+    CP437_FONTS_COUNT * CP437_FONT_GLYPH_COUNT, // glyph_count
+    sizeof(CP437_DATA_TYPE), // scan_line_stride
+    TEXT_MODE_FONT_GLYPH_MAJOR, // layout
+    NULL // blank_rows
 };
 
 const CP437_SECTION_ATTRIBUTE CP437_DATA_TYPE cp437_bitmaps[CP437_FONTS_COUNT][CP437_FONT_GLYPH_COUNT][CP437_FONT_HEIGHT] = {{
@@ -4,7 +4,11 @@
 #include "pico.h"
 #include "text_mode_font.h"
 
-#if TEXT_MODE_MAX_FONT_WIDTH <= 16
+/**
+ * Type of each row of a glyph's bitmap: the same size as TEXT_MODE_FONT_DATA_TYPE, or with
+ * TEXT_MODE_PER_FONT_STORAGE, the smallest one the 9 pixel glyphs fit in.
+ */
+#if TEXT_MODE_MAX_FONT_WIDTH <= 16 || TEXT_MODE_PER_FONT_STORAGE
 #define CP437_DATA_TYPE unsigned short
 #else
 #define CP437_DATA_TYPE unsigned int
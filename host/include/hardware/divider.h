@@ -0,0 +1,23 @@
+#ifndef HOST_HARDWARE_DIVIDER_H
+#define HOST_HARDWARE_DIVIDER_H
+#include "pico.h"
+
+/** Quotient in the high word, remainder in the low word, same as the SDK. */
+typedef uint64_t divmod_result_t;
+
+static inline divmod_result_t hw_divider_divmod_u32(uint32_t a, uint32_t b)
+{
+    return ((divmod_result_t)(a / b) << 32) | (a % b);
+}
+
+static inline uint32_t to_quotient_u32(divmod_result_t r)
+{
+    return (uint32_t)(r >> 32);
+}
+
+static inline uint32_t to_remainder_u32(divmod_result_t r)
+{
+    return (uint32_t)r;
+}
+
+#endif /* HOST_HARDWARE_DIVIDER_H */
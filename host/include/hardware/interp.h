@@ -0,0 +1,148 @@
+#ifndef HOST_HARDWARE_INTERP_H
+#define HOST_HARDWARE_INTERP_H
+/*
+ * Software model of the RP2040 interpolator behind the same API as the Pico SDK's hardware/interp.h.
+ * Implements shift, mask, sign extension, cross input, cross result, add raw, force MSB,
+ * and INTERP1's clamp mode, following section 2.3.1.6 of the RP2040 datasheet.
+ * Blend mode and the overflow flags are not modeled.
+ */
+#include "pico.h"
+
+#define SIO_INTERP0_CTRL_LANE0_SHIFT_LSB         0
+#define SIO_INTERP0_CTRL_LANE0_SHIFT_BITS        0x0000001fu
+#define SIO_INTERP0_CTRL_LANE0_MASK_LSB_LSB      5
+#define SIO_INTERP0_CTRL_LANE0_MASK_LSB_BITS     0x000003e0u
+#define SIO_INTERP0_CTRL_LANE0_MASK_MSB_LSB      10
+#define SIO_INTERP0_CTRL_LANE0_MASK_MSB_BITS     0x00007c00u
+#define SIO_INTERP0_CTRL_LANE0_SIGNED_BITS       0x00008000u
+#define SIO_INTERP0_CTRL_LANE0_CROSS_INPUT_BITS  0x00010000u
+#define SIO_INTERP0_CTRL_LANE0_CROSS_RESULT_BITS 0x00020000u
+#define SIO_INTERP0_CTRL_LANE0_ADD_RAW_BITS      0x00040000u
+#define SIO_INTERP0_CTRL_LANE0_FORCE_MSB_LSB     19
+#define SIO_INTERP0_CTRL_LANE0_FORCE_MSB_BITS    0x00180000u
+#define SIO_INTERP0_CTRL_LANE0_BLEND_BITS        0x00200000u
+#define SIO_INTERP1_CTRL_LANE0_CLAMP_BITS        0x00400000u
+
+/** State of one interpolator. */
+typedef struct interp_hw
+{
+    uint32_t accum[2];
+    uint32_t base[3];
+    uint32_t ctrl[2];
+    /** Lanes claimed with interp_claim_lane_mask(). */
+    uint32_t claimed;
+    /** Only INTERP1 has clamp mode. */
+    bool has_clamp;
+} interp_hw_t;
+
+extern interp_hw_t interp_model_hw[2];
+#define interp0_hw (&interp_model_hw[0])
+#define interp1_hw (&interp_model_hw[1])
+#define interp0 interp0_hw
+#define interp1 interp1_hw
+
+typedef struct
+{
+    uint32_t ctrl;
+} interp_config;
+
+static inline interp_config interp_default_config(void)
+{
+    interp_config c = { 0 };
+    c.ctrl = 31u << SIO_INTERP0_CTRL_LANE0_MASK_MSB_LSB;
+    return c;
+}
+
+static inline void interp_config_set_shift(interp_config* c, unsigned shift)
+{
+    c->ctrl = (c->ctrl & ~SIO_INTERP0_CTRL_LANE0_SHIFT_BITS) | (shift << SIO_INTERP0_CTRL_LANE0_SHIFT_LSB);
+}
+
+static inline void interp_config_set_mask(interp_config* c, unsigned mask_lsb, unsigned mask_msb)
+{
+    c->ctrl = (c->ctrl & ~(SIO_INTERP0_CTRL_LANE0_MASK_LSB_BITS | SIO_INTERP0_CTRL_LANE0_MASK_MSB_BITS))
+        | (mask_lsb << SIO_INTERP0_CTRL_LANE0_MASK_LSB_LSB)
+        | (mask_msb << SIO_INTERP0_CTRL_LANE0_MASK_MSB_LSB);
+}
+
+static inline void interp_config_set_flag(interp_config* c, uint32_t bits, bool on)
+{
+    c->ctrl = on ? c->ctrl | bits : c->ctrl & ~bits;
+}
+
+static inline void interp_config_set_cross_input(interp_config* c, bool cross_input)
+{
+    interp_config_set_flag(c, SIO_INTERP0_CTRL_LANE0_CROSS_INPUT_BITS, cross_input);
+}
+
+static inline void interp_config_set_cross_result(interp_config* c, bool cross_result)
+{
+    interp_config_set_flag(c, SIO_INTERP0_CTRL_LANE0_CROSS_RESULT_BITS, cross_result);
+}
+
+static inline void interp_config_set_signed(interp_config* c, bool _signed)
+{
+    interp_config_set_flag(c, SIO_INTERP0_CTRL_LANE0_SIGNED_BITS, _signed);
+}
+
+static inline void interp_config_set_add_raw(interp_config* c, bool add_raw)
+{
+    interp_config_set_flag(c, SIO_INTERP0_CTRL_LANE0_ADD_RAW_BITS, add_raw);
+}
+
+static inline void interp_config_set_force_bits(interp_config* c, unsigned bits)
+{
+    c->ctrl = (c->ctrl & ~SIO_INTERP0_CTRL_LANE0_FORCE_MSB_BITS) | (bits << SIO_INTERP0_CTRL_LANE0_FORCE_MSB_LSB);
+}
+
+static inline void interp_config_set_clamp(interp_config* c, bool clamp)
+{
+    interp_config_set_flag(c, SIO_INTERP1_CTRL_LANE0_CLAMP_BITS, clamp);
+}
+
+void interp_set_config(interp_hw_t* interp, unsigned lane, interp_config* config);
+
+static inline void interp_claim_lane_mask(interp_hw_t* interp, unsigned lane_mask)
+{
+    assert(!(interp->claimed & lane_mask));
+    interp->claimed |= lane_mask;
+}
+
+static inline void interp_unclaim_lane_mask(interp_hw_t* interp, unsigned lane_mask)
+{
+    interp->claimed &= ~lane_mask;
+}
+
+static inline void interp_set_base(interp_hw_t* interp, unsigned lane, uint32_t val)
+{
+    interp->base[lane] = val;
+}
+
+static inline uint32_t interp_get_base(interp_hw_t* interp, unsigned lane)
+{
+    return interp->base[lane];
+}
+
+static inline void interp_set_accumulator(interp_hw_t* interp, unsigned lane, uint32_t val)
+{
+    interp->accum[lane] = val;
+}
+
+static inline uint32_t interp_get_accumulator(interp_hw_t* interp, unsigned lane)
+{
+    return interp->accum[lane];
+}
+
+/** Reads a lane's result without side effects (PEEK0/PEEK1). */
+uint32_t interp_peek_lane_result(interp_hw_t* interp, unsigned lane);
+
+/** Reads a lane's result and writes both lanes' results back to the accumulators (POP0/POP1). */
+uint32_t interp_pop_lane_result(interp_hw_t* interp, unsigned lane);
+
+/** Reads the full result without side effects (PEEK_FULL). */
+uint32_t interp_peek_full_result(interp_hw_t* interp);
+
+/** Reads the full result and writes both lanes' results back to the accumulators (POP_FULL). */
+uint32_t interp_pop_full_result(interp_hw_t* interp);
+
+#endif /* HOST_HARDWARE_INTERP_H */
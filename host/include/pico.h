@@ -0,0 +1,18 @@
+#ifndef HOST_PICO_H
+#define HOST_PICO_H
+/*
+ * Minimal stand-in for the Pico SDK's pico.h so the portable parts of the text stack can be built
+ * on a desktop machine.  Section placement attributes do nothing off-device.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+#define __not_in_flash(group)
+#define __not_in_flash_func(func_name) func_name
+#define __scratch_x(group)
+#define __scratch_y(group)
+#define __time_critical_func(func_name) func_name
+
+#endif /* HOST_PICO_H */
@@ -0,0 +1,15 @@
+#ifndef HOST_PICO_SCANVIDEO_COMPOSABLE_SCANLINE_H
+#define HOST_PICO_SCANVIDEO_COMPOSABLE_SCANLINE_H
+/*
+ * Stand-in for pico_scanvideo's composable scan line tokens.
+ * On the device these are instruction offsets in the PIO program, so only their meaning matters here.
+ */
+#define COMPOSABLE_COLOR_RUN 0
+#define COMPOSABLE_EOL_ALIGN 1
+#define COMPOSABLE_RAW_RUN 2
+#define COMPOSABLE_RAW_1P 3
+#define COMPOSABLE_RAW_2P 4
+#define COMPOSABLE_EOL_SKIP_ALIGN 5
+#define COMPOSABLE_RAW_1P_SKIP_ALIGN 6
+
+#endif /* HOST_PICO_SCANVIDEO_COMPOSABLE_SCANLINE_H */
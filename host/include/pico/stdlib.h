@@ -0,0 +1,4 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+#include "pico.h"
+#endif /* HOST_PICO_STDLIB_H */
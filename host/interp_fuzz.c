@@ -0,0 +1,275 @@
+/*
+ * Runs the font decoder's exact interpolator sequence through the interpolator model and checks it
+ * against the portable generator.
+ * 
+ * The first part sweeps every font width from 1 to 30 and throws random glyph rows and colors at the
+ * decoder.  Colors that fit in the width's documented number of color bits must always decode
+ * correctly; for wider colors, the number of bad pixels is only reported, which shows what the
+ * color-bit sacrifice for wide fonts actually costs.
+ * It then sweeps every width from 1 to 32 again with TEXT_MODE_SPLIT_DECODE's pass sequence, where all
+ * 16-bit colors must decode correctly.
+ * The second part renders random screens at the compiled TEXT_MODE_MAX_FONT_WIDTH and
+ * TEXT_MODE_PALETTIZED_COLOR with both the model and text_mode_reference_generate_line().
+ * 
+ * Usage: interp_fuzz [seed]
+ * Returns non-zero if any in-range color decoded incorrectly.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hardware/interp.h"
+#include "text_mode_interp.h"
+#include "text_mode_reference.h"
+#include "monofonts12.h"
+#include "cp437.h"
+
+/** Random glyph rows tried per width and color range. */
+#define CELL_TRIALS 200000
+/** Random screens rendered per font. */
+#define SCREEN_TRIALS 20
+#define SCREEN_COLS 37
+#define SCREEN_ROWS 5
+
+static uint32_t rng_state;
+
+/** xorshift32 */
+static uint32_t fuzz_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+
+/**
+ * Decodes one row of one cell the way text_mode_generate_line() does:
+ * load the colors into the bases, load the shifted glyph row into both accumulators,
+ * and POP0 once per pixel, storing from the rightmost pixel to the leftmost.
+ */
+static void fuzz_decode_cell(uint16_t* write, uint32_t bits, uint32_t foreground, uint32_t background,
+    unsigned width, unsigned shift)
+{
+    interp_set_base(interp1, 1, foreground + (1u << (shift - 1)));
+    interp_set_base(interp1, 0, background);
+    interp_set_accumulator(interp1, 0, bits << shift);
+    interp_set_accumulator(interp1, 1, bits << shift);
+    for (unsigned bit = width; bit > 0; bit--)
+        write[bit - 1] = interp_pop_lane_result(interp1, 0);
+}
+
+
+/**
+ * Decodes one row of one cell the way text_mode_generate_line() does with TEXT_MODE_SPLIT_DECODE:
+ * the raw glyph row also goes into INTERP0's accumulators, which text_mode_configure_split_interp() has set
+ * up, and each later pass reloads INTERP1's accumulators from one of INTERP0's lanes.
+ * INTERP1 must be configured with TEXT_MODE_SHIFT_AMOUNT_FOR_WIDTH(TEXT_MODE_SPLIT_PIXELS).
+ */
+static void fuzz_decode_split_cell(uint16_t* write, uint32_t bits, uint32_t foreground, uint32_t background,
+    unsigned width)
+{
+    unsigned shift = TEXT_MODE_SHIFT_AMOUNT_FOR_WIDTH(TEXT_MODE_SPLIT_PIXELS);
+    interp_set_base(interp1, 1, foreground + (1u << (shift - 1)));
+    interp_set_base(interp1, 0, background);
+    interp_set_accumulator(interp0, 0, bits);
+    interp_set_accumulator(interp0, 1, bits);
+    interp_set_accumulator(interp1, 0, bits << shift);
+    interp_set_accumulator(interp1, 1, bits << shift);
+    for (unsigned bit = width; bit > 0; bit--) {
+        if (bit == TEXT_MODE_SPLIT_PIXELS || bit == 2 * TEXT_MODE_SPLIT_PIXELS) {
+            if (bit != width) {
+                uint32_t pass = interp_peek_lane_result(interp0, bit == TEXT_MODE_SPLIT_PIXELS ? 0 : 1) << shift;
+                interp_set_accumulator(interp1, 0, pass);
+                interp_set_accumulator(interp1, 1, pass);
+            }
+        }
+        write[bit - 1] = interp_pop_lane_result(interp1, 0);
+    }
+}
+
+
+/**
+ * Counts pixels of a random cell that decode differently from the intended output.
+ */
+static unsigned fuzz_cell(unsigned width, unsigned shift, uint32_t color_mask, bool split)
+{
+    uint16_t pixels[32];
+    uint32_t bits = fuzz_random() & (0xFFFFFFFFu >> (32 - width));
+    uint32_t foreground = fuzz_random() & color_mask;
+    uint32_t background = fuzz_random() & color_mask;
+    if (split)
+        fuzz_decode_split_cell(pixels, bits, foreground, background, width);
+    else
+        fuzz_decode_cell(pixels, bits, foreground, background, width, shift);
+    uint16_t set = foreground + (1u << (shift - 1));
+    unsigned bad = 0;
+    for (unsigned x = 0; x < width; x++)
+        if (pixels[x] != ((bits >> (width - 1 - x)) & 1 ? set : background))
+            bad++;
+    return bad;
+}
+
+
+/**
+ * Sweeps all font widths.
+ * @return Number of incorrectly decoded pixels with in-range colors
+ */
+static unsigned long fuzz_widths(void)
+{
+    unsigned long total_bad = 0;
+    printf("width shift color-bits  in-range-bad  16-bit-bad\n");
+    for (unsigned width = 1; width <= 30; width++) {
+        unsigned shift = TEXT_MODE_SHIFT_AMOUNT_FOR_WIDTH(width);
+        unsigned color_bits = shift > 16 ? 16 : shift - 1;
+        text_mode_configure_interp(interp1, shift);
+        unsigned long bad = 0, wide_bad = 0;
+        for (unsigned i = 0; i < CELL_TRIALS; i++) {
+            bad += fuzz_cell(width, shift, (1u << color_bits) - 1, false);
+            wide_bad += fuzz_cell(width, shift, 0xFFFF, false);
+        }
+        printf("%5u %5u %10u  %12lu  %9.3f%%\n", width, shift, color_bits, bad,
+            100.0 * wide_bad / ((double)CELL_TRIALS * width));
+        total_bad += bad;
+    }
+    return total_bad;
+}
+
+
+/**
+ * Sweeps all font widths with the split decode.
+ * @return Number of incorrectly decoded pixels, all of which count since every 16-bit color is in range
+ */
+static unsigned long fuzz_split_widths(void)
+{
+    unsigned long total_bad = 0;
+    unsigned shift = TEXT_MODE_SHIFT_AMOUNT_FOR_WIDTH(TEXT_MODE_SPLIT_PIXELS);
+    printf("split width  16-bit-bad\n");
+    text_mode_configure_interp(interp1, shift);
+    for (unsigned width = 1; width <= 32; width++) {
+        // Leave junk in the BASE registers, as an application using INTERP0 might.
+        interp_set_base(interp0, 0, fuzz_random());
+        interp_set_base(interp0, 1, fuzz_random());
+        text_mode_configure_split_interp(interp0, width);
+        unsigned long bad = 0;
+        for (unsigned i = 0; i < CELL_TRIALS; i++)
+            bad += fuzz_cell(width, shift, 0xFFFF, true);
+        printf("%11u  %10lu\n", width, bad);
+        total_bad += bad;
+    }
+    return total_bad;
+}
+
+
+/**
+ * Renders a whole line with the interpolator model, following text_mode_generate_line().
+ */
+static uint16_t* fuzz_model_generate_line(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette)
+{
+    unsigned char_row = scanline % font->scan_lines;
+    unsigned row = scanline / font->scan_lines;
+    const text_cell* cell = text_buffer_cell(screen, 0, row);
+    color_pair row_colors = text_buffer_row_colors(screen, row);
+    const unsigned char* data = text_mode_font_row(font, char_row);
+    for (coord_x col = screen->size.x; col > 0; col--, cell++) {
+        color_pair colors = text_cell_colors(cell, row_colors);
+#if TEXT_MODE_PALETTIZED_COLOR
+        uint32_t foreground = palette[colors.foreground];
+        uint32_t background = palette[colors.background];
+#else
+        (void)palette;
+        uint32_t foreground = colors.foreground;
+        uint32_t background = colors.background;
+#endif
+        uint32_t bits = text_mode_font_bits(font, data + cell->glyph * font->bytes_per_glyph);
+#if TEXT_MODE_SPLIT_DECODE
+        fuzz_decode_split_cell(write, bits, foreground, background, font->scan_pixels);
+#else
+        fuzz_decode_cell(write, bits, foreground, background, font->scan_pixels, TEXT_MODE_SHIFT_AMOUNT);
+#endif
+        write += font->scan_pixels;
+    }
+    return write;
+}
+
+
+/**
+ * Returns a random pair of cell colors.
+ * In palettized mode, any palette index will do, since the palette is kept within color_mask.
+ */
+static color_pair fuzz_random_colors(uint32_t color_mask)
+{
+    uint32_t mask = TEXT_MODE_PALETTIZED_COLOR ? 0xFF : color_mask;
+    color_pair colors = { fuzz_random() & mask, fuzz_random() & mask };
+    return colors;
+}
+
+
+/**
+ * Compares the model against the portable generator on random screens.
+ * @return Number of mismatched pixels
+ */
+static unsigned long fuzz_screens(const char* name, const text_mode_font* font, unsigned glyph_count)
+{
+    static uint16_t expected[SCREEN_COLS * TEXT_MODE_MAX_FONT_WIDTH];
+    static uint16_t actual[SCREEN_COLS * TEXT_MODE_MAX_FONT_WIDTH];
+    uint16_t palette[256];
+    uint32_t color_mask = (1u << TEXT_MODE_COLOR_BITS) - 1;
+    text_buffer* screen = text_buffer_ctor(SCREEN_COLS, SCREEN_ROWS);
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    color_pair row_colors[SCREEN_ROWS];
+    screen->row_colors = row_colors;
+#endif
+    unsigned long bad = 0;
+    text_mode_configure_interp(interp1, TEXT_MODE_SHIFT_AMOUNT);
+#if TEXT_MODE_SPLIT_DECODE
+    text_mode_configure_split_interp(interp0, font->scan_pixels);
+#endif
+    for (unsigned trial = 0; trial < SCREEN_TRIALS; trial++) {
+        for (unsigned i = 0; i < 256; i++)
+            palette[i] = fuzz_random() & color_mask;
+        for (unsigned i = 0; i < SCREEN_COLS * SCREEN_ROWS; i++) {
+            text_cell* cell = &screen->buffer[i];
+            cell->glyph = fuzz_random() % glyph_count;
+            text_cell_set_colors(cell, fuzz_random_colors(color_mask));
+        }
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+        for (unsigned i = 0; i < SCREEN_ROWS; i++)
+            row_colors[i] = fuzz_random_colors(color_mask);
+#endif
+        for (unsigned y = 0; y < SCREEN_ROWS * font->scan_lines; y++) {
+            uint16_t* end = text_mode_reference_generate_line(expected, y, screen, font, palette);
+            fuzz_model_generate_line(actual, y, screen, font, palette);
+            for (uint16_t* e = expected, * a = actual; e < end; e++, a++)
+                if (*e != *a)
+                    bad++;
+        }
+    }
+    text_buffer_dtor(screen);
+    printf("%s: %lu mismatched pixels against text_mode_reference_generate_line\n", name, bad);
+    return bad;
+}
+
+
+int main(int argc, char** argv)
+{
+    rng_state = argc > 1 ? strtoul(argv[1], NULL, 0) : 0x2040;
+    if (!rng_state)
+        rng_state = 1;
+    printf("TEXT_MODE_MAX_FONT_WIDTH=%d TEXT_MODE_PALETTIZED_COLOR=%d TEXT_MODE_GLYPH_ONLY_CELLS=%d "
+        "TEXT_MODE_SPLIT_DECODE=%d seed %u\n", TEXT_MODE_MAX_FONT_WIDTH, TEXT_MODE_PALETTIZED_COLOR,
+        TEXT_MODE_GLYPH_ONLY_CELLS, TEXT_MODE_SPLIT_DECODE, rng_state);
+    unsigned long bad = fuzz_widths();
+    bad += fuzz_split_widths();
+    bad += fuzz_screens("mono12", &mono_font_12_normal, MONO_FONTS_COUNT * MONO_FONT_GLYPH_COUNT);
+    text_mode_font* transposed = malloc(sizeof(text_mode_font));
+    text_mode_font_transpose(transposed, malloc(text_mode_font_data_size(&mono_font_12_normal)),
+        &mono_font_12_normal);
+    bad += fuzz_screens("mono12-t", transposed, transposed->glyph_count);
+#if TEXT_MODE_MAX_FONT_WIDTH > 8
+    bad += fuzz_screens("cp437", &cp437, CP437_FONT_GLYPH_COUNT);
+#endif
+    printf(bad ? "FAILED\n" : "OK\n");
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * Software model of the RP2040 interpolator.  See host/include/hardware/interp.h.
+ */
+#include "hardware/interp.h"
+
+interp_hw_t interp_model_hw[2] = {
+    { .ctrl = { 31u << SIO_INTERP0_CTRL_LANE0_MASK_MSB_LSB, 31u << SIO_INTERP0_CTRL_LANE0_MASK_MSB_LSB } },
+    { .ctrl = { 31u << SIO_INTERP0_CTRL_LANE0_MASK_MSB_LSB, 31u << SIO_INTERP0_CTRL_LANE0_MASK_MSB_LSB },
+      .has_clamp = true },
+};
+
+
+void interp_set_config(interp_hw_t* interp, unsigned lane, interp_config* config)
+{
+    assert(lane < 2);
+    assert(!(config->ctrl & SIO_INTERP0_CTRL_LANE0_BLEND_BITS));
+    // Clamp only exists on INTERP1 LANE0; elsewhere the bit is reserved.
+    assert(!(config->ctrl & SIO_INTERP1_CTRL_LANE0_CLAMP_BITS) || (interp->has_clamp && lane == 0));
+    interp->ctrl[lane] = config->ctrl;
+}
+
+
+/**
+ * Internal routine: Shifted and masked value of a lane, before BASE is added.
+ */
+static uint32_t interp_model_masked(const interp_hw_t* interp, unsigned lane)
+{
+    uint32_t ctrl = interp->ctrl[lane];
+    uint32_t input = ctrl & SIO_INTERP0_CTRL_LANE0_CROSS_INPUT_BITS ? interp->accum[!lane] : interp->accum[lane];
+    unsigned shift = (ctrl & SIO_INTERP0_CTRL_LANE0_SHIFT_BITS) >> SIO_INTERP0_CTRL_LANE0_SHIFT_LSB;
+    unsigned lsb = (ctrl & SIO_INTERP0_CTRL_LANE0_MASK_LSB_BITS) >> SIO_INTERP0_CTRL_LANE0_MASK_LSB_LSB;
+    unsigned msb = (ctrl & SIO_INTERP0_CTRL_LANE0_MASK_MSB_BITS) >> SIO_INTERP0_CTRL_LANE0_MASK_MSB_LSB;
+    uint32_t mask = (0xFFFFFFFFu >> (31 - msb)) & (0xFFFFFFFFu << lsb);
+    uint32_t value = (input >> shift) & mask;
+    if (ctrl & SIO_INTERP0_CTRL_LANE0_SIGNED_BITS && msb < 31 && value & (1u << msb))
+        value |= 0xFFFFFFFFu << (msb + 1);
+    return value;
+}
+
+
+/**
+ * Internal routine: Full lane result, including BASE and clamping.
+ */
+static uint32_t interp_model_lane_result(const interp_hw_t* interp, unsigned lane)
+{
+    uint32_t ctrl = interp->ctrl[lane];
+    uint32_t masked = interp_model_masked(interp, lane);
+    if (ctrl & SIO_INTERP1_CTRL_LANE0_CLAMP_BITS) {
+        // Clamp replaces the addition: BASE0 is the lower bound and BASE1 the upper bound.
+        if (ctrl & SIO_INTERP0_CTRL_LANE0_SIGNED_BITS) {
+            if ((int32_t)masked < (int32_t)interp->base[0])
+                return interp->base[0];
+            if ((int32_t)masked > (int32_t)interp->base[1])
+                return interp->base[1];
+        } else {
+            if (masked < interp->base[0])
+                return interp->base[0];
+            if (masked > interp->base[1])
+                return interp->base[1];
+        }
+        return masked;
+    }
+    if (ctrl & SIO_INTERP0_CTRL_LANE0_ADD_RAW_BITS)
+        masked = ctrl & SIO_INTERP0_CTRL_LANE0_CROSS_INPUT_BITS ? interp->accum[!lane] : interp->accum[lane];
+    return masked + interp->base[lane];
+}
+
+
+/**
+ * Internal routine: Writes lane results back to the accumulators, as happens on any POP.
+ */
+static void interp_model_writeback(interp_hw_t* interp)
+{
+    uint32_t result0 = interp_model_lane_result(interp, 0);
+    uint32_t result1 = interp_model_lane_result(interp, 1);
+    interp->accum[0] = interp->ctrl[0] & SIO_INTERP0_CTRL_LANE0_CROSS_RESULT_BITS ? result1 : result0;
+    interp->accum[1] = interp->ctrl[1] & SIO_INTERP0_CTRL_LANE0_CROSS_RESULT_BITS ? result0 : result1;
+}
+
+
+/**
+ * Internal routine: Lane result as the processor reads it from PEEK or POP.
+ * FORCE_MSB only changes what's presented on the bus, not the result written back or clamped.
+ */
+static uint32_t interp_model_read_lane(const interp_hw_t* interp, unsigned lane)
+{
+    uint32_t force = (interp->ctrl[lane] & SIO_INTERP0_CTRL_LANE0_FORCE_MSB_BITS) >> SIO_INTERP0_CTRL_LANE0_FORCE_MSB_LSB;
+    return interp_model_lane_result(interp, lane) | force << 28;
+}
+
+
+uint32_t interp_peek_lane_result(interp_hw_t* interp, unsigned lane)
+{
+    return interp_model_read_lane(interp, lane);
+}
+
+
+uint32_t interp_pop_lane_result(interp_hw_t* interp, unsigned lane)
+{
+    uint32_t result = interp_model_read_lane(interp, lane);
+    interp_model_writeback(interp);
+    return result;
+}
+
+
+uint32_t interp_peek_full_result(interp_hw_t* interp)
+{
+    return interp->base[2] + interp_model_masked(interp, 0) + interp_model_masked(interp, 1);
+}
+
+
+uint32_t interp_pop_full_result(interp_hw_t* interp)
+{
+    uint32_t result = interp_peek_full_result(interp);
+    interp_model_writeback(interp);
+    return result;
+}
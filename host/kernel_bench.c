@@ -0,0 +1,267 @@
+/*
+ * Benchmarks the portable cell kernels against each other across font widths.
+ * For every width up to TEXT_MODE_MAX_FONT_WIDTH, this makes a font of random glyphs and a row of
+ * random cells about a screen wide, renders every scan line of it many times with each kernel,
+ * and reports nanoseconds per pixel.
+ * Every kernel's output is also checked against text_mode_reference_generate_cells(),
+ * both starting on a word boundary and starting one pixel past one.
+ * With TEXT_MODE_CELL_STYLES, the lookup table kernel is also run through text_mode_style_generate_cells(),
+ * once on plain cells, which shows what the style check costs text without styles,
+ * and once with every eighth cell styled, checked against the reference kernel run the same way.
+ * The lookup table kernel is also run through text_mode_repeat_generate_cells(), on the random cells,
+ * which shows what looking for runs costs text without any, and on a row that is mostly rules of
+ * identical cells, next to the kernel on its own on the same row.
+ *
+ * Host timings only show how the kernels compare to each other;
+ * the demo's BENCHMARK_KERNELS option measures cycles per pixel on the device.
+ *
+ * Usage: kernel_bench [seed]
+ * Returns non-zero if any kernel's output differs from the reference.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "text_mode_kernel.h"
+#include "text_mode_reference.h"
+#include "text_mode_lut.h"
+#include "text_mode_style.h"
+#include "text_mode_repeat.h"
+
+#define BENCH_GLYPHS 256
+#define BENCH_LINES 16
+/** Rough width of the rendered row, in pixels. */
+#define BENCH_PIXELS 800
+/** Times every scan line of the row is rendered for timing. */
+#define BENCH_REPEATS 2000
+
+#if TEXT_MODE_CELL_STYLES
+/** text_mode_reference_generate_cells() with styles applied. */
+static uint16_t* bench_reference_styles(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors)
+{
+    return text_mode_style_generate_cells(write, cells, count, font_row, font, palette, colors,
+        text_mode_reference_generate_cells);
+}
+
+
+/** text_mode_lut_generate_cells() with styles applied. */
+static uint16_t* bench_lut_styles(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors)
+{
+    return text_mode_style_generate_cells(write, cells, count, font_row, font, palette, colors,
+        text_mode_lut_generate_cells);
+}
+#endif
+
+
+/** text_mode_lut_generate_cells() with runs of identical cells copied. */
+static uint16_t* bench_lut_repeat(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors)
+{
+    return text_mode_repeat_generate_cells(write, cells, count, font_row, font, palette, colors,
+        text_mode_lut_generate_cells);
+}
+
+
+/** A kernel to benchmark. */
+typedef struct bench_kernel
+{
+    const char* name;
+    text_mode_cells_kernel kernel;
+    /** Kernel whose output this one has to match. */
+    text_mode_cells_kernel expected;
+    /** If true, some of the cells are given styles first. */
+    bool styled;
+    /** If true, most of the cells are made into runs of identical cells first. */
+    bool rules;
+} bench_kernel;
+
+static const bench_kernel bench_kernels[] = {
+    { "reference", text_mode_reference_generate_cells, text_mode_reference_generate_cells, false, false },
+    { "lut", text_mode_lut_generate_cells, text_mode_reference_generate_cells, false, false },
+#if TEXT_MODE_CELL_STYLES
+    { "lut+style", bench_lut_styles, text_mode_reference_generate_cells, false, false },
+    { "styled", bench_lut_styles, bench_reference_styles, true, false },
+#endif
+    { "lut+repeat", bench_lut_repeat, text_mode_reference_generate_cells, false, false },
+    { "lut rules", text_mode_lut_generate_cells, text_mode_reference_generate_cells, false, true },
+    { "rep rules", bench_lut_repeat, text_mode_reference_generate_cells, false, true },
+#if TEXT_MODE_CELL_STYLES
+    { "rep styled", bench_lut_repeat, bench_reference_styles, true, true },
+#endif
+};
+#define BENCH_KERNEL_COUNT (sizeof(bench_kernels) / sizeof(bench_kernels[0]))
+
+static uint32_t rng_state;
+
+/** xorshift32 */
+static uint32_t bench_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+
+static double bench_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static TEXT_MODE_FONT_DATA_TYPE bench_font_data[BENCH_GLYPHS][BENCH_LINES];
+static text_cell bench_cells[BENCH_PIXELS];
+/** The random cells, before bench_set_rules() changes them. */
+static text_cell bench_random_cells[BENCH_PIXELS];
+/** Colors of the whole row, for TEXT_MODE_GLYPH_ONLY_CELLS. */
+static color_pair bench_row_colors;
+static uint16_t bench_palette[256];
+/** Output lines, with room for a misaligned start. */
+static uint16_t bench_expected[BENCH_PIXELS + 32];
+static uint16_t bench_actual[BENCH_PIXELS + 32];
+
+
+/**
+ * Fills the font and cells with random data for a given width.
+ * Colors are kept within TEXT_MODE_COLOR_BITS, since the interpolator kernel can't show any others.
+ */
+static void bench_randomize(unsigned width, unsigned cols)
+{
+    for (unsigned glyph = 0; glyph < BENCH_GLYPHS; glyph++)
+        for (unsigned line = 0; line < BENCH_LINES; line++)
+            bench_font_data[glyph][line] = bench_random() & (0xFFFFFFFFu >> (32 - width));
+    uint32_t color_mask = (1u << TEXT_MODE_COLOR_BITS) - 1;
+    for (unsigned i = 0; i < 256; i++)
+        bench_palette[i] = bench_random() & color_mask;
+    // A few color pairs, like real text, so the lookup table cache sees realistic reuse.
+    text_color colors[4];
+    for (unsigned i = 0; i < 4; i++)
+        colors[i] = bench_random() & color_mask;
+    for (unsigned x = 0; x < cols; x++) {
+        bench_cells[x].glyph = bench_random() % BENCH_GLYPHS;
+        text_cell_set_colors(&bench_cells[x], (color_pair){ colors[bench_random() % 4], colors[bench_random() % 4] });
+    }
+    bench_row_colors = (color_pair){ colors[0], colors[1] };
+    memcpy(bench_random_cells, bench_cells, sizeof(bench_cells));
+}
+
+
+/**
+ * Turns the first 16 of every 20 cells into a run of copies of the first, like a row of box drawing rules
+ * with short labels in between, or puts the random cells back.
+ */
+static void bench_set_rules(unsigned cols, bool rules)
+{
+    memcpy(bench_cells, bench_random_cells, sizeof(bench_cells));
+    if (rules)
+        for (unsigned x = 0; x < cols; x++)
+            if (x % 20 && x % 20 < 16)
+                bench_cells[x] = bench_cells[x - 1];
+}
+
+
+/**
+ * Gives every eighth cell a random mix of styles, or clears every cell's styles.
+ * Does nothing without TEXT_MODE_CELL_STYLES.
+ */
+static void bench_set_styles(unsigned cols, bool styled)
+{
+    for (unsigned x = 0; x < cols; x++)
+        text_cell_set_style(&bench_cells[x], styled && !(x % 8) ? 1 + bench_random() % 15 : 0);
+}
+
+
+/**
+ * Checks a kernel against another on every scan line.
+ * @return Number of scan lines that differ
+ */
+static unsigned bench_verify(text_mode_cells_kernel kernel, text_mode_cells_kernel expected,
+    const text_mode_font* font, unsigned cols)
+{
+    unsigned bad = 0;
+    for (unsigned offset = 0; offset < 2; offset++)
+        for (unsigned line = 0; line < BENCH_LINES; line++) {
+            const void* row = text_mode_font_row(font, line);
+            memset(bench_expected, 0, sizeof(bench_expected));
+            memset(bench_actual, 0, sizeof(bench_actual));
+            uint16_t* expected_end = expected(bench_expected + offset, bench_cells, cols, row, font, bench_palette,
+                bench_row_colors);
+            uint16_t* actual_end = kernel(bench_actual + offset, bench_cells, cols, row, font, bench_palette,
+                bench_row_colors);
+            if (expected_end - bench_expected != actual_end - bench_actual
+                || memcmp(bench_expected, bench_actual, sizeof(bench_expected)))
+                bad++;
+        }
+    return bad;
+}
+
+
+/**
+ * Times a kernel over every scan line of the row.
+ * @return Nanoseconds per pixel
+ */
+static double bench_time(text_mode_cells_kernel kernel, const text_mode_font* font, unsigned cols)
+{
+    double start = bench_seconds();
+    for (unsigned i = 0; i < BENCH_REPEATS; i++)
+        for (unsigned line = 0; line < BENCH_LINES; line++)
+            kernel(bench_actual, bench_cells, cols, text_mode_font_row(font, line), font, bench_palette,
+                bench_row_colors);
+    double elapsed = bench_seconds() - start;
+    return elapsed * 1e9 / ((double)BENCH_REPEATS * BENCH_LINES * cols * font->scan_pixels);
+}
+
+
+int main(int argc, char** argv)
+{
+    rng_state = argc > 1 ? strtoul(argv[1], NULL, 0) : 0x1234567;
+    if (!rng_state)
+        rng_state = 1;
+    static const unsigned widths[] = { 4, 6, 7, 8, 9, 12, 15, 16, 20, 24, 30, 32 };
+    unsigned failures = 0;
+    printf("TEXT_MODE_MAX_FONT_WIDTH=%d TEXT_MODE_PALETTIZED_COLOR=%d TEXT_MODE_GLYPH_ONLY_CELLS=%d "
+        "TEXT_MODE_SPLIT_DECODE=%d TEXT_MODE_CELL_STYLES=%d (ns/pixel)\n", TEXT_MODE_MAX_FONT_WIDTH,
+        TEXT_MODE_PALETTIZED_COLOR, TEXT_MODE_GLYPH_ONLY_CELLS, TEXT_MODE_SPLIT_DECODE, TEXT_MODE_CELL_STYLES);
+    printf("width");
+    for (unsigned k = 0; k < BENCH_KERNEL_COUNT; k++)
+        printf(" %10s", bench_kernels[k].name);
+    printf("\n");
+    for (unsigned w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+        unsigned width = widths[w];
+        if (width > TEXT_MODE_MAX_FONT_WIDTH)
+            break;
+        unsigned cols = BENCH_PIXELS / width;
+        text_mode_font font = {
+            width,
+            BENCH_LINES,
+            sizeof(TEXT_MODE_FONT_DATA_TYPE),
+            sizeof(TEXT_MODE_FONT_DATA_TYPE) * BENCH_LINES,
+            bench_font_data,
+            BENCH_GLYPHS,
+            sizeof(TEXT_MODE_FONT_DATA_TYPE),
+            TEXT_MODE_FONT_GLYPH_MAJOR,
+            NULL,
+        };
+        bench_randomize(width, cols);
+        printf("%5u", width);
+        for (unsigned k = 0; k < BENCH_KERNEL_COUNT; k++) {
+            bench_set_rules(cols, bench_kernels[k].rules);
+            bench_set_styles(cols, bench_kernels[k].styled);
+            unsigned bad = bench_verify(bench_kernels[k].kernel, bench_kernels[k].expected, &font, cols);
+            if (bad) {
+                printf(" %7u BAD", bad);
+                failures++;
+                continue;
+            }
+            printf(" %10.3f", bench_time(bench_kernels[k].kernel, &font, cols));
+        }
+        printf("\n");
+    }
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
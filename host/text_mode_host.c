@@ -0,0 +1,1486 @@
+/*
+ * Off-device driver for the text stack.
+ * Fills a text buffer the same way the demo does, renders whole frames with the portable scan line
+ * generator, and reports a checksum of the pixels along with how long rendering took.
+ * Pass a file name to also get the frame as a PPM image.
+ * The mono12-t run uses a scan-line-major copy of the font, mono12-c renders through the row cache,
+ * mono12-2 renders lines in pairs, mono12-l uses the lookup table kernel, mono12-b sends blank spans
+ * as color runs, and mono12-a renders through attribute runs; all of them should have the same checksum
+ * as mono12.
+ * The mono12-s run adds four spacing lines below each row, which are sent as color runs.
+ * With TEXT_MODE_CELL_STYLES, the title is underlined and each paragraph gets a different mix of text styles,
+ * and with TEXT_MODE_DOUBLE_SIZE_ROWS, the title is double width and two rows make a double height heading,
+ * so the checksums differ from a build without them.
+ * The rainbow runs repeat the attribute run comparison on a screen where no two neighboring cells
+ * share colors, which is its worst case.
+ * Finally, every generator renders the text through a set of scrolled and clipped views, with and without
+ * line spacing, which are checked pixel for pixel against the matching slice of the unclipped lines,
+ * with styles applied by a separate model of what each style looks like, and double size rows stretched
+ * from the matching normal lines.
+ * The mono12-vr run renders the views with runs of identical cells copied instead of rendered, in single lines
+ * and in pairs.
+ * The mono12-vk runs repeat the views with a cursor of each shape drawn over them, in and out of its blink,
+ * and the mono12-vp runs with a pointer sprite drawn over them at places that cut it off on every side.
+ * The mono12-vo runs do the same with a popup overlay that is partly see-through, when the colors leave room
+ * for the transparency bit.
+ * The mono12-r runs render with copies of the font made by text_mode_font_relocate(), whole and cut down to ASCII
+ * in both layouts, which must match the original pixel for pixel.
+ * With TEXT_MODE_PER_FONT_STORAGE, the mono12-m and cp437-m runs do the same with copies of the fonts widened to
+ * TEXT_MODE_FONT_DATA_TYPE, and the mono12-vf runs have rows of each storage width on the same screen.
+ * With TEXT_MODE_ROW_FONTS, the mono12-vf runs repeat the views with a line map, and a few rows in a font
+ * cut down to fewer lines, plus a CP437 title row when the font width allows it; the expected lines find
+ * each row by adding up row heights instead of from the map.
+ * With TEXT_MODE_BITMAP_REGIONS, the mono12-vg runs repeat the views with 1 and 4 bit bitmap regions over
+ * some of the text, which the expected lines draw pixel by pixel over the cells.
+ * With TEXT_MODE_TILE_ROWS, the mono12-vt runs do the same with a few rows drawn from color tiles.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "text_buffer.h"
+#include "text_window.h"
+#include "text_mode_reference.h"
+#include "text_mode_row_cache.h"
+#include "text_mode_attr_runs.h"
+#include "text_mode_runs.h"
+#include "text_mode_lut.h"
+#include "text_mode_repeat.h"
+#include "text_mode_composable.h"
+#include "text_mode_clip.h"
+#include "text_mode_cursor.h"
+#include "text_mode_sprite.h"
+#include "text_mode_overlay.h"
+#include "text_mode_row_map.h"
+#include "text_mode_bitmap.h"
+#include "text_mode_tile.h"
+#include "monofonts12.h"
+#include "cp437.h"
+
+#define TEXT_ROWS ((SCREEN_HEIGHT + MONO_FONT_HEIGHT - 1) / MONO_FONT_HEIGHT)
+#define TEXT_COLS ((SCREEN_WIDTH + MONO_FONT_WIDTH - 1) / MONO_FONT_WIDTH)
+/** Longest line of pixels any of the fonts can produce. */
+#define LINE_PIXELS (TEXT_COLS * TEXT_MODE_MAX_FONT_WIDTH)
+/** Number of frames rendered for timing. */
+#define TIMING_FRAMES 50
+
+/** Same six-bit colors as the demo. */
+enum COLORS6BPP
+{
+    BLACK         = 0b000000,
+    BLUE          = 0b100000,
+    BRIGHT_WHITE  = 0b111111,
+};
+
+#if TEXT_MODE_PALETTIZED_COLOR
+static uint16_t host_palette[256];
+#else
+#define host_palette NULL
+#endif
+
+static text_buffer host_buffer = STATIC_TEXT_BUFFER(TEXT_COLS, TEXT_ROWS, BRIGHT_WHITE, BLACK, ' ', 0);
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+static color_pair host_row_colors[TEXT_ROWS];
+#endif
+#if TEXT_MODE_DOUBLE_SIZE_ROWS
+static unsigned char host_row_sizes[TEXT_ROWS];
+#endif
+
+static uint16_t frame[SCREEN_HEIGHT][SCREEN_WIDTH];
+
+/** Cursor host_check_views() draws over every line, or NULL for none. */
+static const text_mode_cursor* host_cursor;
+/** Frame number host_check_views() draws the cursor for. */
+static unsigned host_cursor_frame;
+/** Sprite host_check_views() draws over every line, or NULL for none. */
+static const text_mode_sprite* host_sprite;
+/** Overlay host_check_views() draws over every line, or NULL for none. */
+static const text_mode_overlay* host_overlay;
+
+
+/**
+ * Fills the buffer with a title bar and some word-wrapped prose.
+ * @param title_font Font ID for the title bar, which must exist in the font being rendered
+ */
+static void host_fill_buffer(text_buffer* buffer, unsigned char title_font)
+{
+    buffer->colors.foreground = BLACK;
+    buffer->colors.background = BRIGHT_WHITE;
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    buffer->row_colors = host_row_colors;
+    text_buffer_set_row_colors(buffer, 0, buffer->size.y, buffer->colors);
+#endif
+#if TEXT_MODE_DOUBLE_SIZE_ROWS
+    // A double width title, and a double height heading part way down that doesn't line up with a paragraph.
+    buffer->row_sizes = host_row_sizes;
+    host_row_sizes[0] = TEXT_ROW_DOUBLE_WIDTH;
+    host_row_sizes[5] = TEXT_ROW_DOUBLE_HEIGHT_TOP;
+    host_row_sizes[6] = TEXT_ROW_DOUBLE_HEIGHT_BOTTOM;
+#endif
+    text_window title_window;
+    text_window_ctor_in_place(&title_window, buffer, (coord){ 0, 0 }, (coord){ buffer->size.x, 2 });
+    title_window.font = title_font;
+    text_window_set_style(&title_window, TEXT_STYLE_UNDERLINE);
+    text_window_put_string_centered_line(&title_window, "The Picture of Dorian Gray");
+    text_window_newline_no_scroll(&title_window);
+    text_window_put_string_centered_line(&title_window, "Oscar Wilde");
+    text_window main_window;
+    text_window_ctor_in_place(&main_window, buffer, (coord){ 0, title_window.size.y },
+        (coord){ buffer->size.x, buffer->size.y - title_window.size.y });
+    main_window.colors.foreground = BRIGHT_WHITE;
+    main_window.colors.background = BLUE;
+    text_window_erase(&main_window);
+    for (int i = 0; i < 8; i++) {
+        // Goes through every style bit, alone and in combination.
+        text_window_set_style(&main_window, (i * 3) & 0xF);
+        text_window_put_string_word_wrap_partial(&main_window,
+            "The artist is the creator of beautiful things.  To reveal art and conceal the artist is art's "
+            "aim.  The critic is he who can translate into another manner or a new material his impression of "
+            "beautiful things.\n");
+    }
+}
+
+
+/**
+ * Gives every cell different colors from its neighbors, like the demo's commented-out rainbow effect.
+ * This is the worst case for anything that relies on runs of identical colors.
+ * With TEXT_MODE_GLYPH_ONLY_CELLS, every row gets different colors instead.
+ */
+static void host_fill_rainbow(text_buffer* buffer)
+{
+    text_cell* cell = text_buffer_cell(buffer, 0, 0);
+    for (int i = 0; i < buffer->size.x * buffer->size.y; i++, cell++)
+        text_cell_set_colors(cell, (color_pair){ i & 0x3F, ~i & 0x3F });
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    for (int i = 0; i < buffer->size.y; i++)
+        buffer->row_colors[i] = (color_pair){ i & 0x3F, ~i & 0x3F };
+#endif
+}
+
+
+/**
+ * Writes one scan line's worth of composable tokens, the way the render loop does,
+ * but without the end-of-line token.
+ */
+typedef uint16_t* (*host_generator)(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette);
+
+
+/**
+ * Renders the whole line as one raw run with the portable generator.
+ */
+static uint16_t* host_generate_line(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette)
+{
+    uint16_t* end = text_mode_reference_generate_line(text_mode_begin_raw_run(write), scanline, screen, font, palette);
+    return text_mode_end_raw_run(write, end);
+}
+
+
+/**
+ * Renders the whole line as one raw run with the lookup table kernel.
+ */
+static uint16_t* host_generate_line_lut(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette)
+{
+    uint16_t* end = text_mode_lut_generate_line(text_mode_begin_raw_run(write), scanline, screen, font, palette);
+    return text_mode_end_raw_run(write, end);
+}
+
+
+/**
+ * Renders the cell a clip cuts off on the left or right of a row, which the row cache and attribute runs
+ * leave out, the same way the device does.
+ * @param line Scan line of the buffer, from text_mode_view_line()
+ * @param font Font of the line's row
+ * @param tail Whether to render the right one instead of the left one
+ */
+static uint16_t* host_generate_cut_cell(uint16_t* write, unsigned line, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette, const text_mode_clip* clip, bool tail)
+{
+    text_row_line at = text_mode_locate_line(screen, font, line);
+    unsigned row = at.row;
+    const void* font_row = text_mode_font_row(font, at.line);
+    color_pair colors = text_buffer_row_colors(screen, row);
+    if (tail)
+        return clip->tail ? text_mode_clip_generate_cell(write, text_buffer_cell(screen, clip->col + clip->cols, row),
+            0, clip->tail, font_row, font, palette, colors, text_mode_reference_generate_cells) : write;
+    return clip->head ? text_mode_clip_generate_cell(write, text_buffer_cell(screen, clip->col - 1, row),
+        clip->skip, clip->head, font_row, font, palette, colors, text_mode_reference_generate_cells) : write;
+}
+
+
+static text_mode_row_cache host_row_cache;
+
+/**
+ * Renders through the row cache, the same way text_mode_generate_line_cached() does.
+ */
+static uint16_t* host_generate_line_cached(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette)
+{
+    unsigned line = text_mode_view_line(screen, font, scanline);
+    text_row_line at = text_mode_locate_line(screen, font, line);
+    const text_mode_font* row_font = text_mode_row_font(screen, font, at.row);
+    text_mode_clip clip = text_mode_clip_view(screen, row_font);
+    if (at.line >= row_font->scan_lines || text_buffer_row_size(screen, at.row)
+            || text_mode_row_tiles(screen, at.row) || text_mode_bitmap_on_row(screen, at.row)
+            || !text_mode_row_cache_update(&host_row_cache, screen, scanline, at.row, clip.col, clip.cols, row_font,
+                palette))
+        return host_generate_line(write, scanline, screen, font, palette);
+    uint16_t* end = host_generate_cut_cell(text_mode_begin_raw_run(write), line, screen, row_font, palette, &clip,
+        false);
+    end = text_mode_row_cache_generate_line(end, &host_row_cache, at.line);
+    end = host_generate_cut_cell(end, line, screen, row_font, palette, &clip, true);
+    return text_mode_end_raw_run(write, end);
+}
+
+
+static text_mode_attr_row host_attr_row;
+
+/**
+ * Renders through attribute runs, the same way text_mode_generate_line_attr_runs() does.
+ */
+static uint16_t* host_generate_line_attr_runs(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette)
+{
+    unsigned line = text_mode_view_line(screen, font, scanline);
+    text_row_line at = text_mode_locate_line(screen, font, line);
+    const text_mode_font* row_font = text_mode_row_font(screen, font, at.row);
+    text_mode_clip clip = text_mode_clip_view(screen, row_font);
+    if (at.line >= row_font->scan_lines || text_buffer_row_size(screen, at.row)
+            || text_mode_row_tiles(screen, at.row) || text_mode_bitmap_on_row(screen, at.row)
+            || !text_mode_attr_row_update(&host_attr_row, screen, scanline, at.row, clip.col, clip.cols, row_font,
+                palette))
+        return host_generate_line(write, scanline, screen, font, palette);
+    uint16_t* end = host_generate_cut_cell(text_mode_begin_raw_run(write), line, screen, row_font, palette, &clip,
+        false);
+    end = text_mode_attr_row_generate_line(end, &host_attr_row, at.line);
+    end = host_generate_cut_cell(end, line, screen, row_font, palette, &clip, true);
+    return text_mode_end_raw_run(write, end);
+}
+
+
+/**
+ * Prints how many cells share each attribute run on average, which is what the attribute run
+ * renderer's savings scale with.
+ * Rows that can't have attribute runs are left out.
+ */
+static void host_print_attr_runs(const char* name, const text_mode_font* font)
+{
+    unsigned runs = 0;
+    unsigned cells = 0;
+    // Rows with styled cells don't get attribute runs at all.
+    for (int row = 0; row < host_buffer.size.y; row++) {
+        if (!text_mode_attr_row_update(&host_attr_row, &host_buffer, 0, row, 0, host_buffer.size.x, font,
+                host_palette))
+            continue;
+        runs += host_attr_row.run_count;
+        cells += host_buffer.size.x;
+    }
+    text_mode_attr_row_invalidate(&host_attr_row);
+    printf("%-9s %.1f cells per attribute run\n", name, runs ? (double)cells / runs : 0.0);
+}
+
+
+/**
+ * Sends blank spans as color runs, the same way the render loop does with TEXT_MODE_BLANK_RUNS.
+ */
+static uint16_t* host_generate_line_runs(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette)
+{
+    return text_mode_generate_line_runs(write, scanline, screen, font, palette, text_mode_reference_generate_cells);
+}
+
+
+/**
+ * text_mode_reference_generate_cells() with runs of identical cells copied, the way every kernel is run
+ * with TEXT_MODE_REPEAT_CELLS.
+ */
+static uint16_t* host_repeat_cells(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors)
+{
+    return text_mode_repeat_generate_cells(write, cells, count, font_row, font, palette, colors,
+        text_mode_reference_generate_cells);
+}
+
+
+/**
+ * Two-line version of host_repeat_cells().
+ */
+static uint16_t* host_repeat_cells_pair(uint16_t* write0, uint16_t* write1, const text_cell* cells,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors)
+{
+    return text_mode_repeat_generate_cells_pair(write0, write1, cells, count, font_row, font, palette, colors,
+        text_mode_reference_generate_cells_pair);
+}
+
+
+/**
+ * Renders through host_repeat_cells(); with a font that has no blank row metadata, this is one raw run.
+ */
+static uint16_t* host_generate_line_repeat(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette)
+{
+    return text_mode_generate_line_runs(write, scanline, screen, font, palette, host_repeat_cells);
+}
+
+
+/**
+ * Same as text_mode_reference_generate_line_pair(), but through host_repeat_cells_pair().
+ */
+static uint16_t* host_generate_line_pair_repeat(uint16_t* write0, uint16_t* write1, unsigned scanline,
+    text_buffer* screen, const text_mode_font* font, const uint16_t* palette)
+{
+    text_row_line at = text_mode_locate_line(screen, font, text_mode_view_line(screen, font, scanline));
+    if (text_buffer_row_size(screen, at.row) || text_mode_row_tiles(screen, at.row)
+            || text_mode_bitmap_on_row(screen, at.row)) {
+        text_mode_reference_generate_line(write1, scanline + 1, screen, font, palette);
+        return text_mode_reference_generate_line(write0, scanline, screen, font, palette);
+    }
+    font = text_mode_row_font(screen, font, at.row);
+    text_mode_clip clip = text_mode_clip_view(screen, font);
+    return text_mode_clip_generate_cells_pair(write0, write1, text_buffer_cell(screen, 0, at.row), &clip,
+        text_mode_font_row(font, at.line), font, palette, text_buffer_row_colors(screen, at.row),
+        host_repeat_cells_pair);
+}
+
+
+/**
+ * Expands composable tokens back into pixels, the way scanvideo's PIO program would.
+ * @return Number of pixels written to out, not counting the black pixel after the end of line
+ */
+static size_t host_decode_tokens(const uint16_t* token, uint16_t* out, size_t max)
+{
+    size_t count = 0;
+    while (true) {
+        unsigned n;
+        switch (*token++) {
+            case COMPOSABLE_COLOR_RUN:
+                n = token[1] + 3;
+                for (unsigned i = 0; i < n; i++)
+                    if (count < max)
+                        out[count++] = token[0];
+                token += 2;
+                break;
+            case COMPOSABLE_RAW_RUN:
+                n = token[1] + 3;
+                if (count < max)
+                    out[count++] = token[0];
+                for (unsigned i = 1; i < n; i++)
+                    if (count < max)
+                        out[count++] = token[i + 1];
+                token += n + 1;
+                break;
+            case COMPOSABLE_RAW_2P:
+                if (count < max)
+                    out[count++] = *token;
+                token++;
+                // fall through
+            case COMPOSABLE_RAW_1P:
+                if (count < max)
+                    out[count++] = *token;
+                token++;
+                break;
+            case COMPOSABLE_EOL_ALIGN:
+            case COMPOSABLE_EOL_SKIP_ALIGN:
+                return count;
+            default:
+                fprintf(stderr, "Bad token %u\n", token[-1]);
+                exit(1);
+        }
+    }
+}
+
+
+/** Statistics for one rendered frame. */
+typedef struct host_stats
+{
+    /** Pixels scanvideo would have displayed, including ones past the right edge. */
+    size_t pixels;
+    /** Halfwords of scan line buffer used, including end-of-line tokens. */
+    size_t halfwords;
+} host_stats;
+
+
+/**
+ * Writes two consecutive scan lines of the same text row, the way the render loop does with
+ * TEXT_MODE_PAIRED_LINES.
+ * @return Modified write0; write1 advances the same amount
+ */
+typedef uint16_t* (*host_pair_generator)(uint16_t* write0, uint16_t* write1, unsigned scanline,
+    text_buffer* screen, const text_mode_font* font, const uint16_t* palette);
+
+
+/**
+ * Renders every scan line of the frame.
+ * @param pair If not NULL, used instead of generate for lines that can be paired with the next one
+ */
+static host_stats host_render_frame(host_generator generate, host_pair_generator pair, const text_mode_font* font)
+{
+    static uint16_t line[2][LINE_PIXELS * 2];
+    host_stats stats = { 0, 0 };
+    for (unsigned y = 0; y < SCREEN_HEIGHT; y++) {
+        unsigned lines = 1;
+        uint16_t* end[2];
+        text_row_line at = text_mode_locate_line(&host_buffer, font, text_mode_view_line(&host_buffer, font, y));
+        bool pairable = at.line + 1u < text_mode_row_font(&host_buffer, font, at.row)->scan_lines;
+        if (pair && y + 1 < SCREEN_HEIGHT && pairable) {
+            end[0] = pair(text_mode_begin_raw_run(line[0]), text_mode_begin_raw_run(line[1]), y, &host_buffer,
+                font, host_palette);
+            end[1] = line[1] + (end[0] - line[0]);
+            end[0] = text_mode_end_raw_run(line[0], end[0]);
+            end[1] = text_mode_end_raw_run(line[1], end[1]);
+            lines = 2;
+        } else
+            end[0] = generate(line[0], y, &host_buffer, font, host_palette);
+        for (unsigned i = 0; i < lines; i++) {
+            end[i] = text_mode_end_scanline(line[i], end[i]);
+            stats.halfwords += end[i] - line[i];
+            stats.pixels += host_decode_tokens(line[i], frame[y + i], SCREEN_WIDTH);
+        }
+        y += lines - 1;
+    }
+    return stats;
+}
+
+
+/** FNV-1a hash of the frame. */
+static uint32_t host_checksum(void)
+{
+    const unsigned char* p = (const unsigned char*)frame;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(frame); i++)
+        hash = (hash ^ p[i]) * 16777619u;
+    return hash;
+}
+
+
+/** Expands one color channel of a pixel to eight bits. */
+static unsigned host_channel(uint16_t pixel, unsigned shift, unsigned count)
+{
+    unsigned max = (1u << count) - 1;
+    return ((pixel >> shift) & max) * 255 / max;
+}
+
+
+static void host_write_ppm(const char* name)
+{
+    FILE* f = fopen(name, "wb");
+    if (!f) {
+        perror(name);
+        return;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    for (unsigned y = 0; y < SCREEN_HEIGHT; y++)
+        for (unsigned x = 0; x < SCREEN_WIDTH; x++) {
+            uint16_t p = frame[y][x];
+            fputc(host_channel(p, PICO_SCANVIDEO_PIXEL_RSHIFT, PICO_SCANVIDEO_PIXEL_RCOUNT), f);
+            fputc(host_channel(p, PICO_SCANVIDEO_PIXEL_GSHIFT, PICO_SCANVIDEO_PIXEL_GCOUNT), f);
+            fputc(host_channel(p, PICO_SCANVIDEO_PIXEL_BSHIFT, PICO_SCANVIDEO_PIXEL_BCOUNT), f);
+        }
+    fclose(f);
+}
+
+
+static double host_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/**
+ * Renders the current contents of host_buffer with a generator, and prints the results.
+ */
+static void host_run(const char* name, host_generator generate, host_pair_generator pair,
+    const text_mode_font* font, const char* ppm)
+{
+    // Clear the frame first so a generator that comes up short can't inherit the previous run's pixels.
+    memset(frame, 0, sizeof(frame));
+    host_stats stats = host_render_frame(generate, pair, font);
+    uint32_t checksum = host_checksum();
+    double start = host_seconds();
+    for (int i = 0; i < TIMING_FRAMES; i++)
+        host_render_frame(generate, pair, font);
+    double elapsed = host_seconds() - start;
+    printf("%-9s checksum %08x  %.2f ns/pixel  %zu halfwords/line\n", name, checksum,
+        elapsed * 1e9 / ((double)stats.pixels * TIMING_FRAMES), stats.halfwords / SCREEN_HEIGHT);
+    if (ppm)
+        host_write_ppm(ppm);
+}
+
+
+/**
+ * Shrinks host_buffer to its first row, so every text row on screen is that one, including the last of one frame
+ * and the first of the next, renders a frame, changes the first cell, and checks that the next frame shows it.
+ * This is what the row cache and attribute runs can get wrong, since they only refill when the row changes.
+ * @return Number of pixels that don't match the plain generator's
+ */
+static unsigned long host_run_frame_edit(const char* name, host_generator generate, const text_mode_font* font)
+{
+    static uint16_t expected[SCREEN_HEIGHT][SCREEN_WIDTH];
+    coord_y rows = host_buffer.size.y;
+    host_buffer.size.y = 1;
+    text_cell* cell = text_buffer_cell(&host_buffer, 0, 0);
+    text_cell saved = *cell;
+    host_render_frame(generate, NULL, font);
+    cell->glyph = cell->glyph == 'X' ? 'O' : 'X';
+    host_render_frame(host_generate_line, NULL, font);
+    memcpy(expected, frame, sizeof(frame));
+    host_render_frame(generate, NULL, font);
+    unsigned long bad = 0;
+    for (unsigned y = 0; y < SCREEN_HEIGHT; y++)
+        for (unsigned x = 0; x < SCREEN_WIDTH; x++)
+            bad += frame[y][x] != expected[y][x];
+    printf("%-9s %lu mismatched pixels after changing a cell between frames\n", name, bad);
+    *cell = saved;
+    host_buffer.size.y = rows;
+    return bad;
+}
+
+
+/**
+ * Views tried by host_check_views(): aligned and unaligned starts, cuts on both sides, views narrower than
+ * a cell, views that run off the right edge of the buffer, and vertical offsets that cut rows and wrap around
+ * the bottom of the buffer, once or several times.
+ */
+static const text_buffer_view host_views[] = {
+    { 0, 0, 0 }, { 0, SCREEN_WIDTH - 5, 0 }, { 3, 0, 1 }, { 5, SCREEN_WIDTH - 13, 7 }, { 17, 3, 0 }, { 9, 1, 0 },
+    { TEXT_COLS * 4 + 1, SCREEN_WIDTH, 5 }, { TEXT_COLS * 8 - 2, 0, 0 }, { TEXT_COLS * 8, 0, 0 },
+    { 0, 0, SCREEN_HEIGHT - 1 }, { 1, 0, SCREEN_HEIGHT * 3 + 11 },
+};
+
+
+/** Line spacings tried with every view by host_check_views(). */
+static const unsigned char host_line_spacings[] = { 0, 3 };
+
+
+/**
+ * Returns the colors a cell is drawn in, swapped if it's TEXT_STYLE_INVERSE.
+ */
+static color_pair host_expected_colors(const text_cell* cell, color_pair row_colors)
+{
+    color_pair colors = text_cell_colors(cell, row_colors);
+    if (text_cell_style(cell) & TEXT_STYLE_INVERSE)
+        return (color_pair){ colors.background, colors.foreground };
+    return colors;
+}
+
+
+/** Halves one color channel of a pixel in place. */
+static uint16_t host_halve_channel(uint16_t pixel, uint16_t halved, unsigned shift, unsigned count)
+{
+    unsigned max = (1u << count) - 1;
+    return halved | (((pixel >> shift) & max) >> 1) << shift;
+}
+
+
+/**
+ * Returns one row of a glyph's bits put together a byte at a time, least significant first,
+ * from the bytes_per_scan bytes the font says it has, without going through text_mode_font_bits().
+ */
+static uint32_t host_glyph_bits(const text_mode_font* font, const void* row)
+{
+    const unsigned char* bytes = row;
+    uint32_t bits = 0;
+    for (unsigned i = 0; i < font->bytes_per_scan && i < sizeof(bits); i++)
+        bits |= (uint32_t)bytes[i] << (8 * i);
+    return bits;
+}
+
+
+/**
+ * Renders a glyph line of a row the way each cell's styles say it should look, one cell at a time:
+ * unstyled cells with text_mode_reference_generate_cells(), and styled ones from scratch.
+ */
+static void host_expected_line(uint16_t* write, unsigned row, unsigned char_row, const text_mode_font* font)
+{
+    color_pair row_colors = text_buffer_row_colors(&host_buffer, row);
+    const void* font_row = text_mode_font_row(font, char_row);
+    for (unsigned col = 0; col < host_buffer.size.x; col++) {
+        const text_cell* cell = text_buffer_cell(&host_buffer, col, row);
+        unsigned style = text_cell_style(cell);
+        if (!style) {
+            write = text_mode_reference_generate_cells(write, cell, 1, font_row, font, host_palette, row_colors);
+            continue;
+        }
+        color_pair colors = host_expected_colors(cell, row_colors);
+#if TEXT_MODE_PALETTIZED_COLOR
+        uint16_t foreground = host_palette[colors.foreground], background = host_palette[colors.background];
+#else
+        uint16_t foreground = colors.foreground, background = colors.background;
+#endif
+        if (style & TEXT_STYLE_HALF_BRIGHT) {
+            uint16_t halved = 0;
+            halved = host_halve_channel(foreground, halved, PICO_SCANVIDEO_PIXEL_RSHIFT, PICO_SCANVIDEO_PIXEL_RCOUNT);
+            halved = host_halve_channel(foreground, halved, PICO_SCANVIDEO_PIXEL_GSHIFT, PICO_SCANVIDEO_PIXEL_GCOUNT);
+            halved = host_halve_channel(foreground, halved, PICO_SCANVIDEO_PIXEL_BSHIFT, PICO_SCANVIDEO_PIXEL_BCOUNT);
+            foreground = halved;
+        }
+        foreground += TEXT_MODE_EMBIGGENER;
+        uint32_t bits = host_glyph_bits(font, (const unsigned char*)font_row + cell->glyph * font->bytes_per_glyph);
+        if ((style & TEXT_STYLE_UNDERLINE && char_row == font->scan_lines - 1u)
+            || (style & TEXT_STYLE_STRIKETHROUGH && char_row == font->scan_lines / 2u))
+            bits = 0xFFFFFFFFu;
+        for (unsigned bit = font->scan_pixels; bit > 0; bit--)
+            *write++ = (bits >> (bit - 1)) & 1 ? foreground : background;
+    }
+}
+
+
+/**
+ * Fills a line with the background color of each cell of a row, which is what its spacing lines show.
+ */
+static void host_expected_spacing(uint16_t* write, unsigned row, const text_mode_font* font)
+{
+    color_pair colors = text_buffer_row_colors(&host_buffer, row);
+    for (unsigned col = 0; col < host_buffer.size.x; col++) {
+        text_color background = host_expected_colors(text_buffer_cell(&host_buffer, col, row), colors).background;
+        for (unsigned x = 0; x < font->scan_pixels; x++)
+#if TEXT_MODE_PALETTIZED_COLOR
+            *write++ = host_palette[background];
+#else
+            *write++ = background;
+#endif
+    }
+}
+
+
+/**
+ * Draws host_buffer's bitmap regions over a glyph line of a normal size row, one pixel at a time.
+ * @param write Unclipped line from host_expected_line()
+ */
+static void host_expected_bitmaps(uint16_t* write, unsigned row, unsigned char_row, const text_mode_font* font)
+{
+#if TEXT_MODE_BITMAP_REGIONS
+    unsigned full = host_buffer.size.x * font->scan_pixels;
+    for (unsigned i = 0; i < host_buffer.bitmap_count; i++) {
+        const text_mode_bitmap* bitmap = &host_buffer.bitmaps[i];
+        if ((int)row < bitmap->position.y || (int)row >= bitmap->position.y + bitmap->size.y)
+            continue;
+        unsigned y = (row - bitmap->position.y) * font->scan_lines + char_row;
+        const unsigned char* data = (const unsigned char*)bitmap->pixels + y * bitmap->stride;
+        unsigned left = bitmap->position.x * font->scan_pixels;
+        for (unsigned x = 0; x < bitmap->size.x * font->scan_pixels && left + x < full; x++) {
+            unsigned color = bitmap->bits == 4 ? data[x / 2] >> (x % 2 ? 0 : 4) & 15 : data[x / 8] >> (7 - x % 8) & 1;
+            write[left + x] = bitmap->palette[color];
+        }
+    }
+#else
+    (void)write;
+    (void)row;
+    (void)char_row;
+    (void)font;
+#endif
+}
+
+
+/**
+ * Replaces a glyph line of a row with its tiles, one pixel at a time, if the row is drawn from tiles.
+ * @param write Unclipped line from host_expected_line()
+ * @return True if the row is a tile row, which bitmap regions aren't drawn on
+ */
+static bool host_expected_tiles(uint16_t* write, unsigned row, unsigned char_row, const text_mode_font* font)
+{
+#if TEXT_MODE_TILE_ROWS
+    const text_mode_tiles* tiles = host_buffer.row_tiles ? host_buffer.row_tiles[row] : NULL;
+    if (!tiles)
+        return false;
+    unsigned line_bytes = (font->scan_pixels + 1) / 2;
+    color_pair colors = text_buffer_row_colors(&host_buffer, row);
+    for (unsigned col = 0; col < host_buffer.size.x; col++) {
+        const text_cell* cell = text_buffer_cell(&host_buffer, col, row);
+        const unsigned char* data = (const unsigned char*)tiles->data
+            + (cell->glyph * font->scan_lines + char_row) * line_bytes;
+        const uint16_t* palette = tiles->palettes + 16 * text_cell_colors(cell, colors).foreground;
+        for (unsigned x = 0; x < font->scan_pixels; x++)
+            *write++ = palette[data[x / 2] >> (x % 2 ? 0 : 4) & 15];
+    }
+    return true;
+#else
+    (void)write;
+    (void)row;
+    (void)char_row;
+    (void)font;
+    return false;
+#endif
+}
+
+
+/**
+ * Draws host_cursor over a glyph line of a row, if it's on the row and hasn't blinked off.
+ * @param write Unclipped line, after any doubling for a double size row
+ * @param glyph_line Scan line of the font the line shows
+ * @param pixels Length of the line
+ */
+static void host_expected_cursor(uint16_t* write, unsigned row, unsigned glyph_line, unsigned pixels,
+    const text_mode_font* font)
+{
+    const text_mode_cursor* cursor = host_cursor;
+    if (!cursor || (unsigned)cursor->position.y != row)
+        return;
+    if (cursor->blink_frames && (uint16_t)(host_cursor_frame - cursor->blink_start) / cursor->blink_frames % 2)
+        return;
+    unsigned thickness = (font->scan_lines + 7) / 8;
+    if (cursor->shape == TEXT_CURSOR_UNDERLINE && glyph_line + thickness < font->scan_lines)
+        return;
+    unsigned width = font->scan_pixels * (text_buffer_row_size(&host_buffer, row) != TEXT_ROW_NORMAL ? 2 : 1);
+    unsigned count = cursor->shape == TEXT_CURSOR_BAR ? (width + 7) / 8 : width;
+    color_pair colors = host_expected_colors(text_buffer_cell(&host_buffer, cursor->position.x, row),
+        text_buffer_row_colors(&host_buffer, row));
+#if TEXT_MODE_PALETTIZED_COLOR
+    uint16_t foreground = host_palette[colors.foreground], background = host_palette[colors.background];
+#else
+    uint16_t foreground = colors.foreground, background = colors.background;
+#endif
+    for (unsigned x = cursor->position.x * width; x < cursor->position.x * width + count && x < pixels; x++)
+        write[x] = write[x] == background ? foreground : background;
+}
+
+
+/**
+ * Draws host_sprite over a scan line of the screen, one pixel at a time.
+ * @param write Pixels of the screen line
+ * @param width Number of pixels the line has
+ */
+static void host_expected_sprite(uint16_t* write, unsigned y, unsigned width)
+{
+    const text_mode_sprite* sprite = host_sprite;
+    if (!sprite || (int)y < sprite->position.y || (int)y >= sprite->position.y + sprite->height)
+        return;
+    unsigned row = y - sprite->position.y;
+    for (int col = 0; col < TEXT_MODE_SPRITE_SIZE; col++) {
+        int x = sprite->position.x + col;
+        if (x < 0 || x >= (int)width || !(sprite->mask[row] >> (TEXT_MODE_SPRITE_SIZE - 1 - col) & 1))
+            continue;
+        write[x] = sprite->image[row] >> (TEXT_MODE_SPRITE_SIZE - 1 - col) & 1 ? sprite->foreground
+            : sprite->background;
+    }
+}
+
+
+/**
+ * Renders a scan line of host_overlay, if it covers the line.
+ * @return End of the overlay's pixels, or pixels if it doesn't cover the line
+ */
+static uint16_t* host_generate_overlay(uint16_t* pixels, unsigned y, const text_mode_font* font)
+{
+    if (!text_mode_overlay_on_line(host_overlay, y, font))
+        return pixels;
+    return text_mode_reference_generate_line(pixels, text_mode_overlay_scanline(host_overlay, y),
+        host_overlay->buffer, font, host_palette);
+}
+
+
+/**
+ * Stores every pixel of a line of host_overlay that doesn't have TEXT_MODE_TRANSPARENT set over a scan line
+ * of the screen, one pixel at a time.
+ * @param write Pixels of the screen line
+ * @param width Number of pixels the line has
+ */
+static void host_expected_overlay(uint16_t* write, unsigned y, unsigned width, const text_mode_font* font)
+{
+    static uint16_t pixels[LINE_PIXELS];
+    uint16_t* end = host_generate_overlay(pixels, y, font);
+    for (int i = 0; i < end - pixels; i++) {
+        int x = host_overlay->position.x + i;
+        if (x >= 0 && x < (int)width && !(pixels[i] & 0x8000))
+            write[x] = pixels[i];
+    }
+}
+
+
+/**
+ * Finds which row of host_buffer a scan line of the buffer is in by adding up the heights of the rows above it,
+ * which is what its line map should say.
+ * @param line Scan line of the buffer, less than host_buffer_lines()
+ * @param row Set to the row
+ * @param row_line Set to the scan line within the row
+ * @return Font of the row
+ */
+static const text_mode_font* host_find_row(unsigned line, const text_mode_font* font, unsigned* row,
+    unsigned* row_line)
+{
+    unsigned r = 0;
+    const text_mode_font* row_font = text_mode_row_font(&host_buffer, font, r);
+    while (line >= row_font->scan_lines + host_buffer.line_spacing) {
+        line -= row_font->scan_lines + host_buffer.line_spacing;
+        row_font = text_mode_row_font(&host_buffer, font, ++r);
+    }
+    *row = r;
+    *row_line = line;
+    return row_font;
+}
+
+
+/**
+ * Returns the height of host_buffer in scan lines, by adding up the heights of its rows.
+ */
+static unsigned host_buffer_lines(const text_mode_font* font)
+{
+    unsigned lines = 0;
+    for (int row = 0; row < host_buffer.size.y; row++)
+        lines += text_mode_row_font(&host_buffer, font, row)->scan_lines + host_buffer.line_spacing;
+    return lines;
+}
+
+
+/**
+ * Rebuilds host_buffer's line map after its line spacing changes, if it has one.
+ */
+static void host_update_line_map(const text_mode_font* font)
+{
+#if TEXT_MODE_ROW_FONTS
+    if (host_buffer.line_map)
+        text_mode_row_map_update(&host_buffer, font, 0);
+#else
+    (void)font;
+#endif
+}
+
+
+/**
+ * Renders every view in host_views with every spacing in host_line_spacings with a generator,
+ * and compares every line with the same slice of the unclipped line from host_expected_line(),
+ * or with the row's backgrounds for spacing lines.
+ * @param pair If not NULL, also checks that each line pair matches
+ * @return Number of mismatched pixels, counting missing and extra pixels
+ */
+static unsigned long host_check_views(host_generator generate, host_pair_generator pair, const text_mode_font* font)
+{
+    static uint16_t expected[2][LINE_PIXELS];
+    static uint16_t line[2][LINE_PIXELS * 2];
+    static uint16_t actual[LINE_PIXELS];
+    unsigned long bad = 0;
+    for (unsigned s = 0; s < sizeof(host_line_spacings); s++) {
+        for (unsigned v = 0; v < sizeof(host_views) / sizeof(host_views[0]); v++) {
+            host_buffer.line_spacing = host_line_spacings[s];
+            host_buffer.view = host_views[v];
+            host_update_line_map(font);
+            unsigned lines = host_buffer_lines(font);
+            for (unsigned y = 0; y < lines; y++) {
+                unsigned count = 1;
+                uint16_t* end[2];
+                unsigned shown = (y + host_buffer.view.y) % lines;
+                unsigned row, row_line;
+                const text_mode_font* row_font = host_find_row(shown, font, &row, &row_line);
+                if (pair && row_line + 1 < row_font->scan_lines) {
+                    end[0] = pair(text_mode_begin_raw_run(line[0]), text_mode_begin_raw_run(line[1]), y, &host_buffer,
+                        font, host_palette);
+                    end[1] = text_mode_end_raw_run(line[1], line[1] + (end[0] - line[0]));
+                    end[0] = text_mode_end_raw_run(line[0], end[0]);
+                    count = 2;
+                } else
+                    end[0] = generate(line[0], y, &host_buffer, font, host_palette);
+                for (unsigned i = 0; i < count; i++) {
+                    row_font = host_find_row(shown + i, font, &row, &row_line);
+                    unsigned full = host_buffer.size.x * row_font->scan_pixels;
+                    unsigned start = host_buffer.view.x < full ? host_buffer.view.x : full;
+                    unsigned width = full - start;
+                    if (host_buffer.view.width && host_buffer.view.width < width)
+                        width = host_buffer.view.width;
+                    unsigned char_row = row_line;
+                    text_row_size size = text_buffer_row_size(&host_buffer, row);
+                    if (size == TEXT_ROW_DOUBLE_HEIGHT_TOP)
+                        char_row /= 2;
+                    else if (size == TEXT_ROW_DOUBLE_HEIGHT_BOTTOM && char_row < row_font->scan_lines)
+                        char_row = (row_font->scan_lines + char_row) / 2;
+                    if (row_line >= row_font->scan_lines)
+                        host_expected_spacing(expected[i], row, row_font);
+                    else {
+                        host_expected_line(expected[i], row, char_row, row_font);
+                        // Double size rows are always text.
+                        if (size == TEXT_ROW_NORMAL && !host_expected_tiles(expected[i], row, char_row, row_font))
+                            host_expected_bitmaps(expected[i], row, char_row, row_font);
+                    }
+                    // Double size rows show the left half of the normal line with every pixel doubled.
+                    if (size != TEXT_ROW_NORMAL)
+                        for (unsigned x = full; x > 0; x--)
+                            expected[i][x - 1] = expected[i][(x - 1) / 2];
+                    if (row_line < row_font->scan_lines)
+                        host_expected_cursor(expected[i], row, char_row, full, row_font);
+                    if (host_overlay)
+                        host_expected_overlay(expected[i] + start, y + i, width, font);
+                    host_expected_sprite(expected[i] + start, y + i, width);
+                    text_mode_end_scanline(line[i], end[i]);
+                    size_t got = host_decode_tokens(line[i], actual, LINE_PIXELS);
+                    // The render loop draws the cursor into a raw run's pixels, which are the decoded pixels here.
+                    text_mode_cursor_draw(actual, host_cursor, y + i, host_cursor_frame, &host_buffer, font,
+                        host_palette);
+                    if (host_overlay) {
+                        static uint16_t pixels[LINE_PIXELS];
+                        text_mode_overlay_merge(actual, actual + got, host_overlay, pixels,
+                            host_generate_overlay(pixels, y + i, font));
+                    }
+                    text_mode_sprite_draw(actual, actual + got, host_sprite, y + i);
+                    bad += got > width ? got - width : width - got;
+                    for (unsigned x = 0; x < width && x < got; x++)
+                        if (actual[x] != expected[i][start + x])
+                            bad++;
+                }
+                y += count - 1;
+            }
+        }
+    }
+    host_buffer.view = (text_buffer_view){ 0, 0, 0 };
+    host_buffer.line_spacing = 0;
+    host_update_line_map(font);
+    return bad;
+}
+
+
+/**
+ * Runs host_check_views() and prints the result.
+ * @return Number of mismatched pixels
+ */
+static unsigned long host_run_views(const char* name, host_generator generate, host_pair_generator pair,
+    const text_mode_font* font)
+{
+    unsigned long bad = host_check_views(generate, pair, font);
+    printf("%-9s %lu mismatched pixels in %u views\n", name, bad,
+        (unsigned)(sizeof(host_views) / sizeof(host_views[0]) * sizeof(host_line_spacings)));
+    return bad;
+}
+
+
+/**
+ * Renders the buffer in a font and then in a copy of its first glyphs made by text_mode_font_relocate(),
+ * which must look the same as long as the text only uses those glyphs, and prints the result.
+ * @return Number of mismatched pixels
+ */
+static unsigned long host_run_relocated(const char* name, const text_mode_font* source, unsigned glyph_count)
+{
+    static uint16_t expected[SCREEN_HEIGHT][SCREEN_WIDTH];
+    memset(frame, 0, sizeof(frame));
+    host_render_frame(host_generate_line, NULL, source);
+    memcpy(expected, frame, sizeof(frame));
+    text_mode_font copy;
+    void* data = malloc((size_t)glyph_count * source->scan_lines * source->bytes_per_scan);
+    text_mode_font_relocate(&copy, data, source, glyph_count);
+    memset(frame, 0, sizeof(frame));
+    host_render_frame(host_generate_line, NULL, &copy);
+    free(data);
+    unsigned long bad = 0;
+    for (unsigned y = 0; y < SCREEN_HEIGHT; y++)
+        for (unsigned x = 0; x < SCREEN_WIDTH; x++)
+            bad += frame[y][x] != expected[y][x];
+    printf("%-9s %lu mismatched pixels with %u glyphs\n", name, bad, glyph_count);
+    return bad;
+}
+
+
+#if TEXT_MODE_PER_FONT_STORAGE
+/**
+ * Renders the buffer in a font and then in a copy of it with every row stored as TEXT_MODE_FONT_DATA_TYPE,
+ * which must look the same, since only the font's storage width is different, and prints the result.
+ * @return Number of mismatched pixels
+ */
+static unsigned long host_run_widened(const char* name, host_generator generate, const text_mode_font* source)
+{
+    static uint16_t expected[SCREEN_HEIGHT][SCREEN_WIDTH];
+    memset(frame, 0, sizeof(frame));
+    host_render_frame(generate, NULL, source);
+    memcpy(expected, frame, sizeof(frame));
+    unsigned lines = source->scan_lines;
+    TEXT_MODE_FONT_DATA_TYPE* data = malloc(sizeof(TEXT_MODE_FONT_DATA_TYPE) * source->glyph_count * lines);
+    for (unsigned glyph = 0; glyph < source->glyph_count; glyph++)
+        for (unsigned line = 0; line < lines; line++)
+            data[glyph * lines + line] = host_glyph_bits(source,
+                (const unsigned char*)text_mode_font_row(source, line) + glyph * source->bytes_per_glyph);
+    text_mode_font wide = { source->scan_pixels, lines, sizeof(TEXT_MODE_FONT_DATA_TYPE),
+        sizeof(TEXT_MODE_FONT_DATA_TYPE) * lines, data, source->glyph_count, sizeof(TEXT_MODE_FONT_DATA_TYPE),
+        TEXT_MODE_FONT_GLYPH_MAJOR, source->blank_rows };
+    // The row cache and attribute runs only know fonts by address, which the last copy may have had.
+    text_mode_row_cache_invalidate(&host_row_cache);
+    text_mode_attr_row_invalidate(&host_attr_row);
+    memset(frame, 0, sizeof(frame));
+    host_render_frame(generate, NULL, &wide);
+    free(data);
+    unsigned long bad = 0;
+    for (unsigned y = 0; y < SCREEN_HEIGHT; y++)
+        for (unsigned x = 0; x < SCREEN_WIDTH; x++)
+            bad += frame[y][x] != expected[y][x];
+    printf("%-9s %lu mismatched pixels with %u byte rows\n", name, bad, (unsigned)source->bytes_per_scan);
+    return bad;
+}
+#endif
+
+
+/**
+ * Cursors tried by host_run_cursors(): every shape, on normal and double size rows,
+ * on the first and last columns, which some views cut, and blinking from either side of a frame number wrap.
+ */
+static const text_mode_cursor host_cursors[] = {
+    { { 3, 0 }, TEXT_CURSOR_BLOCK, 0, 0 },
+    { { 0, 2 }, TEXT_CURSOR_UNDERLINE, 0, 0 },
+    { { TEXT_COLS - 1, 5 }, TEXT_CURSOR_BAR, 0, 0 },
+    { { 7, 6 }, TEXT_CURSOR_UNDERLINE, 30, 0 },
+    { { 20, TEXT_ROWS - 1 }, TEXT_CURSOR_BLOCK, 30, 65530 },
+};
+
+
+/** Frame numbers every cursor is drawn for, which are in and out of each blink. */
+static const unsigned host_cursor_frames[] = { 0, 45 };
+
+
+/**
+ * Runs host_check_views() with each of host_cursors drawn for each of host_cursor_frames, and prints the result.
+ * @return Number of mismatched pixels
+ */
+static unsigned long host_run_cursors(const char* name, host_generator generate, host_pair_generator pair,
+    const text_mode_font* font)
+{
+    unsigned long bad = 0;
+    unsigned cursors = sizeof(host_cursors) / sizeof(host_cursors[0]);
+    unsigned frames = sizeof(host_cursor_frames) / sizeof(host_cursor_frames[0]);
+    for (unsigned c = 0; c < cursors; c++)
+        for (unsigned f = 0; f < frames; f++) {
+            host_cursor = &host_cursors[c];
+            host_cursor_frame = host_cursor_frames[f];
+            bad += host_check_views(generate, pair, font);
+        }
+    host_cursor = NULL;
+    printf("%-9s %lu mismatched pixels with %u cursors\n", name, bad, cursors * frames);
+    return bad;
+}
+
+
+/** An arrow pointer with a one pixel outline, pointing at its top left pixel. */
+static const uint16_t host_arrow_image[] = {
+    0x0000, 0x4000, 0x6000, 0x7000, 0x7800, 0x7C00, 0x7E00, 0x7F00,
+    0x7F80, 0x7C00, 0x6C00, 0x4600, 0x0600, 0x0300, 0x0300, 0x0000,
+};
+static const uint16_t host_arrow_mask[] = {
+    0xC000, 0xE000, 0xF000, 0xF800, 0xFC00, 0xFE00, 0xFF00, 0xFF80,
+    0xFFC0, 0xFFC0, 0xFE00, 0xEF00, 0xCF00, 0x0780, 0x0780, 0x0300,
+};
+
+
+/**
+ * Places tried by host_run_sprites(): inside the screen, cut off by each edge, and on a line that views
+ * narrower than the sprite's position end before.
+ */
+static const coord host_sprite_positions[] = {
+    { 100, 50 }, { -5, -3 }, { -15, 200 }, { SCREEN_WIDTH - 7, SCREEN_HEIGHT - 9 }, { SCREEN_WIDTH - 2, 17 },
+};
+
+
+/**
+ * Runs host_check_views() with an arrow sprite drawn at each of host_sprite_positions, and prints the result.
+ * @return Number of mismatched pixels
+ */
+static unsigned long host_run_sprites(const char* name, host_generator generate, host_pair_generator pair,
+    const text_mode_font* font)
+{
+    unsigned long bad = 0;
+    unsigned positions = sizeof(host_sprite_positions) / sizeof(host_sprite_positions[0]);
+    text_mode_sprite sprite = { { 0, 0 }, 16, 0x0A5A, 0x05A5, host_arrow_image, host_arrow_mask };
+    for (unsigned p = 0; p < positions; p++) {
+        sprite.position = host_sprite_positions[p];
+        host_sprite = &sprite;
+        bad += host_check_views(generate, pair, font);
+    }
+    host_sprite = NULL;
+    printf("%-9s %lu mismatched pixels with %u sprites\n", name, bad, positions);
+    return bad;
+}
+
+
+#if TEXT_MODE_COLOR_BITS >= 16
+/** Background color of the overlay's see-through rows. */
+#if TEXT_MODE_PALETTIZED_COLOR
+#define HOST_TRANSPARENT 0x80
+#else
+#define HOST_TRANSPARENT TEXT_MODE_TRANSPARENT
+#endif
+
+
+/**
+ * Places tried by host_run_overlays(): inside the screen at odd and even pixels,
+ * and cut off by each edge.
+ */
+static const coord host_overlay_positions[] = {
+    { 40, 30 }, { 41, 31 }, { -9, 100 }, { SCREEN_WIDTH - 50, SCREEN_HEIGHT - 20 }, { 7, -13 },
+};
+
+
+/**
+ * Runs host_check_views() with a small popup overlay at each of host_overlay_positions, and prints the result.
+ * The popup has opaque rows at the top and bottom, and see-through rows in between,
+ * and its view starts part way into its first column.
+ * @return Number of mismatched pixels
+ */
+static unsigned long host_run_overlays(const char* name, host_generator generate, host_pair_generator pair,
+    const text_mode_font* font)
+{
+    text_buffer* popup = text_buffer_ctor(24, 5);
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    color_pair popup_rows[5];
+    popup->row_colors = popup_rows;
+#endif
+#if TEXT_MODE_PALETTIZED_COLOR
+    host_palette[HOST_TRANSPARENT] = TEXT_MODE_TRANSPARENT;
+#endif
+    for (int row = 0; row < popup->size.y; row++) {
+        bool opaque = row == 0 || row == popup->size.y - 1;
+        popup->colors = (color_pair){ opaque ? BLACK : BRIGHT_WHITE, opaque ? BRIGHT_WHITE : HOST_TRANSPARENT };
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+        text_buffer_set_row_colors(popup, row, 1, popup->colors);
+#endif
+        text_buffer_set_cursor(popup, 0, row);
+        text_buffer_put_string(popup, opaque ? "== Overlay popup ==     " : " see-through text  1234 ");
+    }
+    // An odd view start keeps the glyphs' pixel pairs from lining up with the merge's pairs.
+    popup->view.x = 3;
+    text_mode_overlay overlay = { popup, { 0, 0 } };
+    unsigned long bad = 0;
+    unsigned positions = sizeof(host_overlay_positions) / sizeof(host_overlay_positions[0]);
+    for (unsigned p = 0; p < positions; p++) {
+        overlay.position = host_overlay_positions[p];
+        host_overlay = &overlay;
+        bad += host_check_views(generate, pair, font);
+    }
+    host_overlay = NULL;
+#if TEXT_MODE_PALETTIZED_COLOR
+    host_palette[HOST_TRANSPARENT] = HOST_TRANSPARENT;
+#endif
+    text_buffer_dtor(popup);
+    printf("%-9s %lu mismatched pixels with %u overlays\n", name, bad, positions);
+    return bad;
+}
+#endif
+
+
+#if TEXT_MODE_BITMAP_REGIONS
+static const uint16_t host_bitmap_palette_1bpp[2] = { 0x0123, 0x7ABC };
+static uint16_t host_bitmap_palette_4bpp[16];
+
+/**
+ * Regions host_set_bitmaps() gives host_buffer: two side by side with text between them, cut on the left by
+ * some views, one whose left edge is cut in the middle of the view, one cut on the right, and one over
+ * double size rows with TEXT_MODE_DOUBLE_SIZE_ROWS, which isn't drawn.
+ */
+static text_mode_bitmap host_bitmaps[] = {
+    { { 0, 2 }, { 6, 2 }, 1 },
+    { { 9, 2 }, { 7, 3 }, 4 },
+    { { TEXT_COLS / 2, 8 }, { 3, 1 }, 4 },
+    { { TEXT_COLS - 5, 9 }, { 5, 2 }, 1 },
+    { { 20, 5 }, { 4, 2 }, 4 },
+};
+
+
+/**
+ * Gives host_buffer the regions in host_bitmaps, filled with pseudo-random pixels, with room for fonts
+ * up to 16 pixels wide and 16 lines high.
+ */
+static void host_set_bitmaps(void)
+{
+    for (unsigned i = 0; i < 16; i++)
+        host_bitmap_palette_4bpp[i] = 0x0421 * i + 3;
+    uint32_t seed = 12345;
+    for (unsigned i = 0; i < sizeof(host_bitmaps) / sizeof(host_bitmaps[0]); i++) {
+        text_mode_bitmap* bitmap = &host_bitmaps[i];
+        bitmap->stride = bitmap->size.x * 16 * bitmap->bits / 8;
+        bitmap->palette = bitmap->bits == 4 ? host_bitmap_palette_4bpp : host_bitmap_palette_1bpp;
+        size_t size = (size_t)bitmap->stride * bitmap->size.y * 16;
+        unsigned char* pixels = malloc(size);
+        for (size_t j = 0; j < size; j++) {
+            seed = seed * 1103515245u + 12345u;
+            pixels[j] = seed >> 16;
+        }
+        bitmap->pixels = pixels;
+    }
+    host_buffer.bitmaps = host_bitmaps;
+    host_buffer.bitmap_count = sizeof(host_bitmaps) / sizeof(host_bitmaps[0]);
+}
+
+
+/**
+ * Takes host_buffer's bitmap regions away again.
+ */
+static void host_clear_bitmaps(void)
+{
+    for (unsigned i = 0; i < sizeof(host_bitmaps) / sizeof(host_bitmaps[0]); i++)
+        free((void*)host_bitmaps[i].pixels);
+    host_buffer.bitmaps = NULL;
+    host_buffer.bitmap_count = 0;
+}
+#endif
+
+
+#if TEXT_MODE_TILE_ROWS
+static const text_mode_tiles* host_row_tiles[TEXT_ROWS];
+
+
+/**
+ * Draws a few rows of host_buffer from a set of pseudo-random tiles with a sub-palette for every color
+ * the cells use, with room for every glyph of a font up to 16 pixels wide and 16 lines high:
+ * one row alone, one with a bitmap region on it, which isn't drawn, and a double size row, which stays text.
+ */
+static void host_set_tiles(void)
+{
+    static text_mode_tiles tiles;
+    static uint16_t palettes[64 * 16];
+    size_t size = (size_t)512 * 8 * 16;
+    unsigned char* data = malloc(size);
+    uint32_t seed = 54321;
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = seed >> 16;
+    }
+    for (unsigned i = 0; i < 64 * 16; i++) {
+        seed = seed * 1103515245u + 12345u;
+        palettes[i] = seed >> 16;
+    }
+    tiles.data = data;
+    tiles.palettes = palettes;
+    host_buffer.row_tiles = host_row_tiles;
+    host_row_tiles[5] = &tiles;
+    host_row_tiles[7] = &tiles;
+    host_row_tiles[8] = &tiles;
+}
+
+
+/**
+ * Takes host_buffer's tiles away again.
+ */
+static void host_clear_tiles(void)
+{
+    free((void*)host_row_tiles[7]->data);
+    host_buffer.row_tiles = NULL;
+    memset(host_row_tiles, 0, sizeof(host_row_tiles));
+}
+#endif
+
+
+#if TEXT_MODE_ROW_FONTS
+static const text_mode_font* host_row_fonts[TEXT_ROWS];
+
+
+/**
+ * Gives host_buffer a line map, and draws a few of its rows in other fonts: the title in title_font,
+ * and some rows further down in other_font, one of which is a double height half with TEXT_MODE_DOUBLE_SIZE_ROWS.
+ */
+static void host_set_row_fonts(const text_mode_font* font, const text_mode_font* title_font,
+    const text_mode_font* other_font)
+{
+    host_buffer.row_fonts = host_row_fonts;
+    host_row_fonts[0] = title_font;
+    host_row_fonts[3] = other_font;
+    host_row_fonts[6] = other_font;
+    host_row_fonts[9] = other_font;
+    // The map has to have room for the widest spacing host_check_views() tries.
+    unsigned lines = 0;
+    for (unsigned s = 0; s < sizeof(host_line_spacings); s++) {
+        host_buffer.line_spacing = host_line_spacings[s];
+        unsigned needed = text_mode_row_map_lines(&host_buffer, font);
+        lines = needed > lines ? needed : lines;
+    }
+    host_buffer.line_spacing = 0;
+    host_buffer.line_map = malloc(sizeof(text_row_line) * lines);
+    host_buffer.line_map_capacity = lines;
+    text_mode_row_map_update(&host_buffer, font, 0);
+    text_mode_row_cache_invalidate(&host_row_cache);
+    text_mode_attr_row_invalidate(&host_attr_row);
+}
+
+
+/**
+ * Takes host_buffer's line map and row fonts away again.
+ */
+static void host_clear_row_fonts(void)
+{
+    free(host_buffer.line_map);
+    host_buffer.line_map = NULL;
+    host_buffer.line_map_lines = 0;
+    host_buffer.line_map_capacity = 0;
+    host_buffer.row_fonts = NULL;
+    memset(host_row_fonts, 0, sizeof(host_row_fonts));
+}
+
+
+/**
+ * Shrinks host_buffer's line map capacity to one entry short of what it needs, and checks that rebuilding the map
+ * cuts it short without writing past the capacity, and that growing a row is refused,
+ * then puts the map back. Row 3 must be in a shorter font than font, as host_set_row_fonts() leaves it.
+ * @return Number of checks that failed
+ */
+static unsigned long host_run_line_map_limit(const char* name, const text_mode_font* font)
+{
+    unsigned long bad = 0;
+    unsigned short capacity = host_buffer.line_map_capacity;
+    unsigned short lines = host_buffer.line_map_lines;
+    const text_mode_font* row_font = host_row_fonts[3];
+    // Past the shrunken capacity, so a write there shows up.
+    text_row_line guard = { 0xFFFF, 0xFFFF };
+    host_buffer.line_map_capacity = lines - 1;
+    host_buffer.line_map[lines - 1] = guard;
+    bad += text_mode_row_map_update(&host_buffer, font, 0);
+    bad += host_buffer.line_map_lines != lines - 1;
+    bad += host_buffer.line_map[lines - 1].row != guard.row;
+    // Back at full height, drawing row 3 in font would need more entries than there are.
+    host_buffer.line_map_capacity = lines;
+    text_mode_row_map_update(&host_buffer, font, 0);
+    bad += text_mode_row_map_set_font(&host_buffer, font, 3, NULL);
+    bad += host_row_fonts[3] != row_font;
+    bad += host_buffer.line_map_lines != lines;
+    host_buffer.line_map_capacity = capacity;
+    text_mode_row_map_update(&host_buffer, font, 0);
+    printf("%-9s %lu bad line map updates past its capacity\n", name, bad);
+    return bad;
+}
+#endif
+
+
+int main(int argc, char** argv)
+{
+#if TEXT_MODE_PALETTIZED_COLOR
+    for (unsigned i = 0; i < 256; i++)
+        host_palette[i] = i;
+#endif
+    printf("TEXT_MODE_MAX_FONT_WIDTH=%d TEXT_MODE_PALETTIZED_COLOR=%d TEXT_MODE_GLYPH_ONLY_CELLS=%d "
+        "TEXT_MODE_SPLIT_DECODE=%d TEXT_MODE_CELL_STYLES=%d TEXT_MODE_DOUBLE_SIZE_ROWS=%d TEXT_MODE_ROW_FONTS=%d "
+        "TEXT_MODE_BITMAP_REGIONS=%d TEXT_MODE_TILE_ROWS=%d TEXT_MODE_PER_FONT_STORAGE=%d\n",
+        TEXT_MODE_MAX_FONT_WIDTH, TEXT_MODE_PALETTIZED_COLOR, TEXT_MODE_GLYPH_ONLY_CELLS, TEXT_MODE_SPLIT_DECODE,
+        TEXT_MODE_CELL_STYLES, TEXT_MODE_DOUBLE_SIZE_ROWS, TEXT_MODE_ROW_FONTS, TEXT_MODE_BITMAP_REGIONS,
+        TEXT_MODE_TILE_ROWS, TEXT_MODE_PER_FONT_STORAGE);
+    host_fill_buffer(&host_buffer, MONO_FONT_BOLD);
+    host_run("mono12", host_generate_line, NULL, &mono_font_12_normal, argc > 1 ? argv[1] : NULL);
+    text_mode_font* transposed = malloc(sizeof(text_mode_font));
+    text_mode_font_transpose(transposed, malloc(text_mode_font_data_size(&mono_font_12_normal)),
+        &mono_font_12_normal);
+    host_run("mono12-t", host_generate_line, NULL, transposed, NULL);
+    text_mode_row_cache_invalidate(&host_row_cache);
+    host_run("mono12-c", host_generate_line_cached, NULL, &mono_font_12_normal, NULL);
+    text_mode_font* with_blank_rows = malloc(sizeof(text_mode_font));
+    text_mode_font_add_blank_rows(with_blank_rows, malloc(sizeof(uint32_t) * mono_font_12_normal.glyph_count),
+        &mono_font_12_normal);
+    host_run("mono12-2", host_generate_line, text_mode_reference_generate_line_pair, &mono_font_12_normal, NULL);
+    host_run("mono12-l", host_generate_line_lut, NULL, &mono_font_12_normal, NULL);
+    host_run("mono12-b", host_generate_line_runs, NULL, with_blank_rows, NULL);
+    host_run("mono12-a", host_generate_line_attr_runs, NULL, &mono_font_12_normal, NULL);
+    host_buffer.line_spacing = 4;
+    host_run("mono12-s", host_generate_line_runs, NULL, &mono_font_12_normal, NULL);
+    host_buffer.line_spacing = 0;
+    host_print_attr_runs("mono12", &mono_font_12_normal);
+    host_fill_rainbow(&host_buffer);
+    host_run("rainbow", host_generate_line, NULL, &mono_font_12_normal, NULL);
+    host_run("rainbow-a", host_generate_line_attr_runs, NULL, &mono_font_12_normal, NULL);
+    host_print_attr_runs("rainbow", &mono_font_12_normal);
+#if TEXT_MODE_MAX_FONT_WIDTH > 8
+    host_fill_buffer(&host_buffer, 0);
+    host_run("cp437", host_generate_line, NULL, &cp437, NULL);
+#endif
+    host_fill_buffer(&host_buffer, MONO_FONT_BOLD);
+    unsigned long bad = host_run_views("mono12-v", host_generate_line, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vc", host_generate_line_cached, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-v2", host_generate_line, text_mode_reference_generate_line_pair,
+        &mono_font_12_normal);
+    bad += host_run_views("mono12-vl", host_generate_line_lut, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vb", host_generate_line_runs, NULL, with_blank_rows);
+    bad += host_run_views("mono12-va", host_generate_line_attr_runs, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vr", host_generate_line_repeat, host_generate_line_pair_repeat,
+        &mono_font_12_normal);
+    bad += host_run_cursors("mono12-vk", host_generate_line, NULL, &mono_font_12_normal);
+    bad += host_run_cursors("mono12-vk2", host_generate_line, text_mode_reference_generate_line_pair,
+        &mono_font_12_normal);
+    bad += host_run_sprites("mono12-vp", host_generate_line, NULL, &mono_font_12_normal);
+    bad += host_run_sprites("mono12-vp2", host_generate_line, text_mode_reference_generate_line_pair,
+        &mono_font_12_normal);
+#if TEXT_MODE_COLOR_BITS >= 16
+    // Wider fonts leak the transparency bit into foreground pixels, so they can't have overlays.
+    bad += host_run_overlays("mono12-vo", host_generate_line, NULL, &mono_font_12_normal);
+    bad += host_run_overlays("mono12-vo2", host_generate_line, text_mode_reference_generate_line_pair,
+        &mono_font_12_normal);
+#endif
+    bad += host_run_frame_edit("mono12-ec", host_generate_line_cached, &mono_font_12_normal);
+    bad += host_run_frame_edit("mono12-ea", host_generate_line_attr_runs, &mono_font_12_normal);
+    bad += host_run_relocated("mono12-r", &mono_font_12_normal, mono_font_12_normal.glyph_count);
+    // The text is all ASCII in the regular font now, so copies cut down to that have every glyph it needs.
+    host_fill_buffer(&host_buffer, 0);
+    bad += host_run_relocated("mono12-r7", &mono_font_12_normal, 128);
+    bad += host_run_relocated("mono12-rt7", transposed, 128);
+#if TEXT_MODE_PER_FONT_STORAGE
+    bad += host_run_widened("mono12-m", host_generate_line, &mono_font_12_normal);
+    bad += host_run_widened("mono12-mt", host_generate_line, transposed);
+    bad += host_run_widened("mono12-ml", host_generate_line_lut, &mono_font_12_normal);
+    bad += host_run_widened("mono12-mc", host_generate_line_cached, &mono_font_12_normal);
+    bad += host_run_widened("mono12-ma", host_generate_line_attr_runs, &mono_font_12_normal);
+    bad += host_run_widened("mono12-mb", host_generate_line_runs, with_blank_rows);
+#endif
+#if TEXT_MODE_MAX_FONT_WIDTH > 8
+    host_fill_buffer(&host_buffer, 0);
+    bad += host_run_views("cp437-v", host_generate_line, NULL, &cp437);
+    bad += host_run_views("cp437-vb", host_generate_line_runs, NULL, &cp437);
+#if TEXT_MODE_PER_FONT_STORAGE && TEXT_MODE_MAX_FONT_WIDTH > 16
+    bad += host_run_widened("cp437-m", host_generate_line, &cp437);
+    bad += host_run_widened("cp437-ml", host_generate_line_lut, &cp437);
+#endif
+#endif
+#if TEXT_MODE_ROW_FONTS
+    // The first 8 lines of each glyph make a shorter font, which moves every row below it up.
+    const text_mode_font* mono = &mono_font_12_normal;
+    text_mode_font cropped = { mono->scan_pixels, 8, mono->bytes_per_scan, mono->bytes_per_glyph, mono->data,
+        mono->glyph_count, mono->scan_line_stride, mono->layout, NULL };
+    host_fill_buffer(&host_buffer, 0);
+#if TEXT_MODE_MAX_FONT_WIDTH > 8
+    // A taller and wider title row, which has cells past the right edge of the other rows.
+    host_set_row_fonts(&mono_font_12_normal, &cp437, &cropped);
+#else
+    host_set_row_fonts(&mono_font_12_normal, &cropped, &cropped);
+#endif
+    bad += host_run_line_map_limit("mono12-fm", &mono_font_12_normal);
+    bad += host_run_views("mono12-vf", host_generate_line, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vfc", host_generate_line_cached, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vf2", host_generate_line, text_mode_reference_generate_line_pair,
+        &mono_font_12_normal);
+    bad += host_run_views("mono12-vfl", host_generate_line_lut, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vfb", host_generate_line_runs, NULL, with_blank_rows);
+    bad += host_run_views("mono12-vfa", host_generate_line_attr_runs, NULL, &mono_font_12_normal);
+    bad += host_run_cursors("mono12-vfk", host_generate_line, NULL, &mono_font_12_normal);
+#if TEXT_MODE_BITMAP_REGIONS
+    host_set_bitmaps();
+    bad += host_run_views("mono12-vfg", host_generate_line, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vfgb", host_generate_line_runs, NULL, with_blank_rows);
+#if TEXT_MODE_TILE_ROWS
+    host_set_tiles();
+    bad += host_run_views("mono12-vft", host_generate_line, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vftb", host_generate_line_runs, NULL, with_blank_rows);
+    host_clear_tiles();
+#endif
+    host_clear_bitmaps();
+#endif
+    host_clear_row_fonts();
+#endif
+#if TEXT_MODE_BITMAP_REGIONS
+    host_fill_buffer(&host_buffer, 0);
+    host_set_bitmaps();
+    bad += host_run_views("mono12-vg", host_generate_line, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vgc", host_generate_line_cached, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vg2", host_generate_line, text_mode_reference_generate_line_pair,
+        &mono_font_12_normal);
+    bad += host_run_views("mono12-vgl", host_generate_line_lut, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vgb", host_generate_line_runs, NULL, with_blank_rows);
+    bad += host_run_views("mono12-vga", host_generate_line_attr_runs, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vgr", host_generate_line_repeat, host_generate_line_pair_repeat,
+        &mono_font_12_normal);
+#if TEXT_MODE_TILE_ROWS
+    host_set_tiles();
+    bad += host_run_views("mono12-vt", host_generate_line, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vtc", host_generate_line_cached, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vt2", host_generate_line, text_mode_reference_generate_line_pair,
+        &mono_font_12_normal);
+    bad += host_run_views("mono12-vtl", host_generate_line_lut, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vtb", host_generate_line_runs, NULL, with_blank_rows);
+    bad += host_run_views("mono12-vta", host_generate_line_attr_runs, NULL, &mono_font_12_normal);
+    bad += host_run_views("mono12-vtr", host_generate_line_repeat, host_generate_line_pair_repeat,
+        &mono_font_12_normal);
+    host_clear_tiles();
+#endif
+    host_clear_bitmaps();
+#endif
+    printf(bad ? "FAILED\n" : "OK\n");
+    return bad ? 1 : 0;
+}
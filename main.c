@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include "pico.h"
 #include "pico/stdlib.h"
 #include "pico/scanvideo.h"
@@ -16,6 +17,11 @@
 #include "text_buffer.h"
 #include "text_window.h"
 #include "text_mode.h"
+#include "text_mode_lut.h"
+#include "text_mode_reference.h"
+#include "text_mode_row_map.h"
+#include "text_mode_bitmap.h"
+#include "text_mode_tile.h"
 #include "monofonts12.h"
 #include "cp437.h"
 
@@ -33,12 +39,34 @@
 // Use CP437 font instead
 // NOTE: Set TEXT_MODE_MAX_FONT_WIDTH to 15 in CMakeLists.txt
 //#define USE_CP437
+// Render from a scan-line-major copy of the font, which keeps each line's font reads close together
+//#define TRANSPOSE_FONT
+// Before starting video, time each scan line kernel rendering the demo text on core 0 and print
+// cycles per pixel over the UART
+//#define BENCHMARK_KERNELS
+// Copy the first this many glyphs of the font into scratch X before starting video, so core 0's RAM accesses
+// can't slow down core 1's glyph reads; 128 is ASCII in the regular font, which is all the demo uses with this.
+// With BENCHMARK_KERNELS, the benchmark also times rendering with and without a pinned font under load.
+// Glyphs past the copy aren't checked for and draw garbage, so only use this with text that stays within it.
+// NOTE: Set TEXT_MODE_FONT_POOL_SIZE in CMakeLists.txt to at least the size of the copy, about 1.5 KB for 128,
+// which leaves no room in scratch X for TEXT_MODE_ROW_CACHE or TEXT_MODE_ATTR_RUNS
+//#define PIN_FONT 128
+// Blank scan lines below each text row, for a roomier layout without a taller font
+//#define LINE_SPACING 4
+// With TEXT_MODE_DUAL_CORE, run at this clock instead of overclocking, since core 0 renders in its spare time;
+// it must be a multiple of the 30 MHz dot clock.  With TEXT_MODE_RENDER_STATS, the demo prints how busy
+// each core is, which shows how much headroom is left.
+//#define DUAL_CORE_CLOCK_KHZ 120000
 
 // If you turn off FULL_RES and change the screen resolution, you may want to override these
 // because the limits chosen below are calibrated specifically for my 800x480 TFT.
 //#define TEXT_ROWS 40
 //#define TEXT_COLS 100
 
+#ifndef LINE_SPACING
+    #define LINE_SPACING 0
+#endif
+
 // Adjust text buffer size to match screen size and what can be rendered fast enough.
 #ifdef USE_CP437
     // Row 35 doesn't fit fully but the render routine doesn't know how to handle having blank lines
@@ -46,7 +74,7 @@
     // gets cut off.
     #ifndef TEXT_ROWS
         // 35
-        #define TEXT_ROWS ((SCREEN_HEIGHT + CP437_FONT_HEIGHT - 1) / CP437_FONT_HEIGHT)
+        #define TEXT_ROWS ((SCREEN_HEIGHT + CP437_FONT_HEIGHT + LINE_SPACING - 1) / (CP437_FONT_HEIGHT + LINE_SPACING))
     #endif
     #ifndef TEXT_COLS
         // 88
@@ -55,7 +83,7 @@
 #else /* not USE_CP437 */
     #ifndef TEXT_ROWS
         // 40
-        #define TEXT_ROWS ((SCREEN_HEIGHT + MONO_FONT_HEIGHT - 1) / MONO_FONT_HEIGHT)
+        #define TEXT_ROWS ((SCREEN_HEIGHT + MONO_FONT_HEIGHT + LINE_SPACING - 1) / (MONO_FONT_HEIGHT + LINE_SPACING))
     #endif
     #ifndef TEXT_COLS
         #ifdef FULL_RES
@@ -71,6 +99,19 @@
     #endif
 #endif /* USE_CP437 */
 
+// Size of main_buffer's line map, which has an entry for every scan line of every row.
+#if TEXT_MODE_ROW_FONTS
+    #ifdef USE_CP437
+        #define LINE_MAP_LINES (TEXT_ROWS * (CP437_FONT_HEIGHT + LINE_SPACING))
+    #elif TEXT_MODE_MAX_FONT_WIDTH > 8
+        // Draw the title row in the taller CP437 font, over the mono font's body text.
+        #define CP437_TITLE
+        #define LINE_MAP_LINES (TEXT_ROWS * (MONO_FONT_HEIGHT + LINE_SPACING) + CP437_FONT_HEIGHT - MONO_FONT_HEIGHT)
+    #else
+        #define LINE_MAP_LINES (TEXT_ROWS * (MONO_FONT_HEIGHT + LINE_SPACING))
+    #endif
+#endif
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /////// 800 x 480 TFT LCD CONFIGURATION ////////////////////////////////////////
@@ -185,17 +226,363 @@ uint16_t main_palette[] = {
     0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
     0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
     0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
+    // Entry 0x40 lets overlays show what's under them.
+    TEXT_MODE_TRANSPARENT,
 };
+/** Background color that lets the text under an overlay show through. */
+#define TRANSPARENT 0x40
+#else
+#define TRANSPARENT TEXT_MODE_TRANSPARENT
 #endif
 
 /** Main text buffer for rendering. */
 text_buffer main_buffer = STATIC_TEXT_BUFFER(TEXT_COLS, TEXT_ROWS, BRIGHT_WHITE, BLACK, ' ', 0);
 
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+/** Colors of each row of main_buffer, since its cells don't have any. */
+color_pair main_row_colors[TEXT_ROWS];
+#endif
+
+#if TEXT_MODE_ROW_FONTS
+/** Font of each row of main_buffer, where NULL is text_mode_current_font. */
+const text_mode_font* main_row_fonts[TEXT_ROWS];
+/** Row and line of the row each scan line of main_buffer shows, so the render loop doesn't have to divide. */
+text_row_line main_line_map[LINE_MAP_LINES];
+#endif
+
+#if TEXT_MODE_OVERLAY
+/** Status line drawn over the bottom of the screen, with only its text covering main_buffer. */
+text_buffer status_buffer = STATIC_TEXT_BUFFER(32, 1, RED, TRANSPARENT, ' ', 0);
+/** Places status_buffer at the bottom right of the screen. */
+text_mode_overlay status_overlay = { .buffer = &status_buffer };
+#endif
+
+/** Blinking cursor drawn over main_buffer, about once a second at 60 Hz. */
+text_mode_cursor main_cursor = { .shape = TEXT_CURSOR_BLOCK, .blink_frames = 30 };
+
+/** Rows of an arrow pointer, pointing at its top left pixel. */
+const uint16_t main_pointer_image[] = {
+    0x0000, 0x4000, 0x6000, 0x7000, 0x7800, 0x7C00, 0x7E00, 0x7F00,
+    0x7F80, 0x7C00, 0x6C00, 0x4600, 0x0600, 0x0300, 0x0300, 0x0000,
+};
+/** The arrow pointer's mask, which gives it a one pixel outline. */
+const uint16_t main_pointer_mask[] = {
+    0xC000, 0xE000, 0xF000, 0xF800, 0xFC00, 0xFE00, 0xFF00, 0xFF80,
+    0xFFC0, 0xFFC0, 0xFE00, 0xEF00, 0xCF00, 0x0780, 0x0780, 0x0300,
+};
+/** Mouse pointer sprite drawn over the screen. */
+text_mode_sprite main_pointer = {
+    .position = { SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 },
+    .height = 16,
+    .foreground = BLACK,
+    .background = BRIGHT_WHITE,
+    .image = main_pointer_image,
+    .mask = main_pointer_mask,
+};
+
+
+#ifdef BENCHMARK_KERNELS
+////////////////////////////////////////////////////////////////////////////////
+/////// BENCHMARK //////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+/** Frames rendered per kernel. */
+#define BENCHMARK_FRAMES 10
+
+/** Signature of text_mode_generate_line() and its variants. */
+typedef uint16_t* (*main_line_generator)(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font);
+
+/** Scratch scan line for benchmarking. */
+static uint16_t main_benchmark_line_buffer[TEXT_COLS * TEXT_MODE_MAX_FONT_WIDTH + 2];
+
+
+/**
+ * Prints cycles per pixel for a benchmark run.
+ */
+static void main_benchmark_print(const char* name, uint64_t elapsed_us, const text_buffer* screen)
+{
+    const text_mode_font* font = text_mode_current_font;
+    uint64_t pixels = (uint64_t)BENCHMARK_FRAMES * screen->size.y * font->scan_lines * screen->size.x * font->scan_pixels;
+    uint64_t cycles = elapsed_us * (clock_get_hz(clk_sys) / 1000000);
+    printf("%s: %u.%02u cycles/pixel\n", name, (unsigned)(cycles / pixels), (unsigned)(cycles * 100 / pixels % 100));
+}
+
+
+/**
+ * Renders BENCHMARK_FRAMES frames of the current buffer with a kernel and prints cycles per pixel.
+ * Video isn't running yet, so nothing else is competing for the RAM banks.
+ */
+static void main_benchmark_kernel(const char* name, text_mode_cells_kernel kernel)
+{
+    const text_mode_font* font = text_mode_current_font;
+    text_buffer* screen = text_mode_current_buffer;
+#if TEXT_MODE_PALETTIZED_COLOR
+    const uint16_t* palette = main_palette;
+#else
+    const uint16_t* palette = NULL;
+#endif
+    unsigned lines = screen->size.y * font->scan_lines;
+    uint64_t start = time_us_64();
+    for (int frame = 0; frame < BENCHMARK_FRAMES; frame++)
+        for (unsigned scanline = 0; scanline < lines; scanline++) {
+            unsigned row = scanline / font->scan_lines;
+            kernel(main_benchmark_line_buffer, text_buffer_cell(screen, 0, row), screen->size.x,
+                text_mode_font_row(font, scanline % font->scan_lines), font, palette,
+                text_buffer_row_colors(screen, row));
+        }
+    main_benchmark_print(name, time_us_64() - start, screen);
+}
+
+
+/**
+ * Same as main_benchmark_kernel(), but for a whole-line generator rendering a given buffer.
+ */
+static void main_benchmark_line(const char* name, main_line_generator generate, text_buffer* screen)
+{
+    const text_mode_font* font = text_mode_current_font;
+    unsigned lines = screen->size.y * font->scan_lines;
+    uint64_t start = time_us_64();
+    for (int frame = 0; frame < BENCHMARK_FRAMES; frame++)
+        for (unsigned scanline = 0; scanline < lines; scanline++)
+            generate(main_benchmark_line_buffer, scanline, screen, font);
+    main_benchmark_print(name, time_us_64() - start, screen);
+}
+
+
+/**
+ * Times compositing the pointer sprite into every line it covers at a spread of positions,
+ * and prints cycles per covered line, which is what each of those lines costs on top of rendering it.
+ */
+static void main_benchmark_sprite(void)
+{
+    text_mode_sprite sprite = main_pointer;
+    unsigned width = sizeof(main_benchmark_line_buffer) / sizeof(main_benchmark_line_buffer[0]);
+    const uint16_t* end = main_benchmark_line_buffer + width;
+    unsigned lines = 0;
+    uint64_t start = time_us_64();
+    for (int i = 0; i < BENCHMARK_FRAMES * 100; i++) {
+        // Odd steps put the sprite at every alignment, and some positions are cut off by the right edge.
+        sprite.position.x = i * 7 % width;
+        for (unsigned row = 0; row < sprite.height; row++, lines++)
+            text_mode_sprite_draw(main_benchmark_line_buffer, end, &sprite, sprite.position.y + row);
+    }
+    uint64_t cycles = (time_us_64() - start) * (clock_get_hz(clk_sys) / 1000000);
+    printf("pointer sprite: %u cycles/covered line\n", (unsigned)(cycles / lines));
+}
+
+
+/**
+ * Compares the scan line kernels on the demo text, and the whole-line generators on both the demo text
+ * and a rainbow screen where no two neighboring cells share colors, and on a screen that is mostly rules.
+ * With TEXT_MODE_CELL_STYLES, also times the demo text with every cell styled,
+ * and with TEXT_MODE_DOUBLE_SIZE_ROWS, with every row double width.
+ * With TEXT_MODE_BITMAP_REGIONS, also times a 1-bit and a 4-bit bitmap region covering the whole screen,
+ * and with TEXT_MODE_TILE_ROWS, every row of the rainbow screen drawn from color tiles.
+ * Finally, times compositing the pointer sprite.
+ */
+static void main_benchmark_kernels(void)
+{
+    printf("\nBenchmarking %u-pixel-wide font\n", text_mode_current_font->scan_pixels);
+    text_mode_setup_interp();
+    main_benchmark_kernel("interpolator", text_mode_generate_cells);
+    main_benchmark_kernel("lookup table", text_mode_lut_generate_cells);
+    main_benchmark_kernel("reference", text_mode_reference_generate_cells);
+    text_buffer* screen = text_mode_current_buffer;
+    text_buffer* rainbow = text_buffer_ctor(screen->size.x, screen->size.y);
+    text_cell* cell = rainbow->buffer;
+    for (int i = 0; i < screen->size.x * screen->size.y; i++, cell++) {
+        *cell = screen->buffer[i];
+        text_cell_set_colors(cell, (color_pair){ i & 0x3F, ~i & 0x3F });
+    }
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    // Cells can't have their own colors, so the best a rainbow can do is change every row.
+    rainbow->row_colors = malloc(sizeof(color_pair) * screen->size.y);
+    for (int i = 0; i < screen->size.y; i++)
+        rainbow->row_colors[i] = (color_pair){ i & 0x3F, ~i & 0x3F };
+#endif
+    main_benchmark_line("line", text_mode_generate_line, screen);
+    main_benchmark_line("rainbow line", text_mode_generate_line, rainbow);
+#if TEXT_MODE_ATTR_RUNS
+    main_benchmark_line("attribute runs", text_mode_generate_line_attr_runs, screen);
+    main_benchmark_line("rainbow attribute runs", text_mode_generate_line_attr_runs, rainbow);
+#endif
+    // Rules of 16 identical cells with a few cells of text between them, like a screen of boxes and progress bars,
+    // which TEXT_MODE_REPEAT_CELLS copies instead of rendering.
+    cell = rainbow->buffer;
+    for (int i = 0; i < screen->size.x * screen->size.y; i++, cell++)
+        *cell = screen->buffer[i % 20 < 16 ? i - i % 20 : i];
+    main_benchmark_line("rules line", text_mode_generate_line, rainbow);
+#if TEXT_MODE_CELL_STYLES
+    // Plain text only pays for checking each cell's style, which "line" already includes;
+    // every cell having a style is the worst case.
+    cell = rainbow->buffer;
+    for (int i = 0; i < screen->size.x * screen->size.y; i++, cell++) {
+        *cell = screen->buffer[i];
+        text_cell_set_style(cell, TEXT_STYLE_UNDERLINE | TEXT_STYLE_HALF_BRIGHT);
+    }
+    main_benchmark_line("styled line", text_mode_generate_line, rainbow);
+#endif
+#if TEXT_MODE_DOUBLE_SIZE_ROWS
+    // Each line shows half as many cells, but every pixel is stored twice.
+    screen->row_sizes = malloc(screen->size.y);
+    memset(screen->row_sizes, TEXT_ROW_DOUBLE_WIDTH, screen->size.y);
+    main_benchmark_line("double width line", text_mode_generate_line, screen);
+    free(screen->row_sizes);
+    screen->row_sizes = NULL;
+#endif
+#if TEXT_MODE_BITMAP_REGIONS
+    // One region over the whole screen; a stride of 0 shows the same row of pixels on every line,
+    // which costs the same as a full bitmap without the RAM for one.
+    const text_mode_font* font = text_mode_current_font;
+    unsigned width = screen->size.x * font->scan_pixels;
+    unsigned char* pixels = malloc(width / 2 + 1);
+    for (unsigned i = 0; i < width / 2 + 1; i++)
+        pixels[i] = i * 37;
+    static const uint16_t palette_1bpp[2] = { 0x0000, 0x7FFF };
+    static uint16_t palette_4bpp[16];
+    for (unsigned i = 0; i < 16; i++)
+        palette_4bpp[i] = i * 0x0842;
+    text_mode_bitmap bitmap = { { 0, 0 }, screen->size, 1, 0, palette_1bpp, pixels };
+    screen->bitmaps = &bitmap;
+    screen->bitmap_count = 1;
+    main_benchmark_line("1-bit bitmap line", text_mode_generate_line, screen);
+    bitmap.bits = 4;
+    bitmap.palette = palette_4bpp;
+    main_benchmark_line("4-bit bitmap line", text_mode_generate_line, screen);
+    screen->bitmaps = NULL;
+    screen->bitmap_count = 0;
+    free(pixels);
+#endif
+#if TEXT_MODE_TILE_ROWS
+    // Every row drawn from 128 tiles, with a sub-palette for each of the 64 colors the rainbow uses.
+    const text_mode_font* tile_font = text_mode_current_font;
+    unsigned tile_bytes = 128 * text_mode_tile_bytes(tile_font);
+    unsigned char* tile_data = malloc(tile_bytes);
+    for (unsigned i = 0; i < tile_bytes; i++)
+        tile_data[i] = i * 37;
+    uint16_t* tile_palettes = malloc(sizeof(uint16_t) * 64 * 16);
+    for (unsigned i = 0; i < 64 * 16; i++)
+        tile_palettes[i] = i * 0x0421;
+    text_mode_tiles tiles = { tile_data, tile_palettes };
+    rainbow->row_tiles = malloc(sizeof(text_mode_tiles*) * screen->size.y);
+    for (int i = 0; i < screen->size.y; i++)
+        rainbow->row_tiles[i] = &tiles;
+    cell = rainbow->buffer;
+    for (int i = 0; i < screen->size.x * screen->size.y; i++, cell++) {
+        *cell = screen->buffer[i];
+        cell->glyph &= 127;
+        text_cell_set_colors(cell, (color_pair){ i & 0x3F, 0 });
+    }
+    main_benchmark_line("tile line", text_mode_generate_line, rainbow);
+    free(rainbow->row_tiles);
+    free(tile_palettes);
+    free(tile_data);
+#endif
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    free(rainbow->row_colors);
+#endif
+    text_buffer_dtor(rainbow);
+    text_mode_release_interp();
+    main_benchmark_sprite();
+}
+
+
+#if TEXT_MODE_FONT_POOL_SIZE
+/** Glyphs main_benchmark_pinning() copies into scratch X, which is ASCII in the regular font. */
+#define BENCHMARK_PINNED_GLYPHS 128
+
+/** Words core 0 copies around main RAM to load it during main_benchmark_pinning(). */
+#define BENCHMARK_HAMMER_WORDS 4096
+
+/** RAM for core 0 to copy around; this isn't static so the copies can't be optimized away. */
+uint32_t main_benchmark_hammer_buffer[BENCHMARK_HAMMER_WORDS];
+
+/** Demo text with every glyph moved into the first BENCHMARK_PINNED_GLYPHS, for main_benchmark_pinned_lines(). */
+static text_buffer* main_benchmark_plain;
+
+
+/**
+ * Runs on core 1, like the render loop: times the line generator with the font in main RAM,
+ * then with a copy pinned to scratch X, and tells core 0 when it's done.
+ */
+static void main_benchmark_pinned_lines(void)
+{
+    const text_mode_font* font = text_mode_current_font;
+    text_mode_setup_interp();
+    main_benchmark_line("  font in main RAM", text_mode_generate_line, main_benchmark_plain);
+    const text_mode_font* pinned = text_mode_pin_font(font, BENCHMARK_PINNED_GLYPHS);
+    if (pinned) {
+        text_mode_current_font = pinned;
+        main_benchmark_line("  font pinned to scratch X", text_mode_generate_line, main_benchmark_plain);
+    } else
+        printf("  font doesn't fit in TEXT_MODE_FONT_POOL_SIZE\n");
+    text_mode_current_font = font;
+    text_mode_unpin_fonts();
+    text_mode_release_interp();
+    multicore_fifo_push_blocking(0);
+}
+
+
+/**
+ * Times rendering on core 1 from a font in main RAM and from one pinned to scratch X,
+ * first with core 0 idle and then with core 0 copying memory around main RAM as fast as it can,
+ * which shows how much the pinned font saves when core 0 is busy.
+ */
+static void main_benchmark_pinning(void)
+{
+    text_buffer* screen = text_mode_current_buffer;
+    main_benchmark_plain = text_buffer_ctor(screen->size.x, screen->size.y);
+    main_benchmark_plain->colors = screen->colors;
+    text_cell* cell = main_benchmark_plain->buffer;
+    for (int i = 0; i < screen->size.x * screen->size.y; i++, cell++) {
+        *cell = screen->buffer[i];
+        cell->glyph &= BENCHMARK_PINNED_GLYPHS - 1;
+    }
+    uint32_t* half = main_benchmark_hammer_buffer + BENCHMARK_HAMMER_WORDS / 2;
+    for (int hammer = 0; hammer < 2; hammer++) {
+        printf(hammer ? "Core 0 copying RAM:\n" : "Core 0 idle:\n");
+        multicore_launch_core1(main_benchmark_pinned_lines);
+        // Copying back and forth reads and writes every bank, since main RAM is striped word by word.
+        while (hammer && !multicore_fifo_rvalid()) {
+            memcpy(half, main_benchmark_hammer_buffer, sizeof(uint32_t) * BENCHMARK_HAMMER_WORDS / 2);
+            memcpy(main_benchmark_hammer_buffer, half, sizeof(uint32_t) * BENCHMARK_HAMMER_WORDS / 2);
+        }
+        multicore_fifo_pop_blocking();
+        multicore_reset_core1();
+    }
+    text_buffer_dtor(main_benchmark_plain);
+}
+#endif
+#endif
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /////// MAIN ///////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
+#if TEXT_MODE_RENDER_STATS
+/**
+ * Prints how many scan lines each core rendered since the last call, and how much of the time it spent on them.
+ */
+static void main_print_stats(void)
+{
+    static text_mode_render_stats last[NUM_CORES];
+    static uint32_t last_time;
+    uint32_t now = time_us_32();
+    uint32_t elapsed = now - last_time;
+    for (unsigned core = 0; core < NUM_CORES; core++) {
+        text_mode_render_stats stats = text_mode_core_stats[core];
+        uint32_t busy = stats.busy_us - last[core].busy_us;
+        printf("core %u: %u lines, %u%% busy  ", core, (unsigned)(stats.lines - last[core].lines),
+            (unsigned)((uint64_t)busy * 100 / elapsed));
+        last[core] = stats;
+    }
+    printf("\n");
+    last_time = now;
+}
+#endif
+
 /** Initialize a GPIO pin for output and set it to a default value. */
 #define gpio_init_out(PIN, DEFAULT) gpio_init(PIN); gpio_set_dir(PIN, 1); gpio_put(PIN, DEFAULT)
 
@@ -205,7 +592,9 @@ int main()
     // Adjust CPU speed to be as fast as needed for selected options.
     // These are calibrated for an 800x480 60 Hz TFT LCD; at lower resolutions (e.g. 640x480 VGA),
     // you may be able to get away with a less aggressive overclock, or even none at all.
-#ifdef FULL_RES
+#if TEXT_MODE_DUAL_CORE && defined(DUAL_CORE_CLOCK_KHZ)
+    set_sys_clock_khz(DUAL_CORE_CLOCK_KHZ, true);
+#elif defined(FULL_RES)
     #if !TEXT_MODE_PALETTIZED_COLOR
         set_sys_clock_khz(180000, true);
     #else
@@ -257,6 +646,18 @@ int main()
 #else
     text_mode_current_font = &cp437;
 #endif
+#ifdef TRANSPOSE_FONT
+    text_mode_font* transposed_font = malloc(sizeof(text_mode_font));
+    text_mode_font_transpose(transposed_font, malloc(text_mode_font_data_size(text_mode_current_font)),
+        text_mode_current_font);
+    text_mode_current_font = transposed_font;
+#endif
+#if TEXT_MODE_BLANK_RUNS
+    text_mode_font* font_with_blank_rows = malloc(sizeof(text_mode_font));
+    text_mode_font_add_blank_rows(font_with_blank_rows, malloc(sizeof(uint32_t) * text_mode_current_font->glyph_count),
+        text_mode_current_font);
+    text_mode_current_font = font_with_blank_rows;
+#endif
 #if TEXT_MODE_PALETTIZED_COLOR
     text_mode_current_palette = main_palette;
 #endif
@@ -266,15 +667,36 @@ int main()
     // Display test text
     main_buffer.colors.foreground = BLACK;
     main_buffer.colors.background = BRIGHT_WHITE;
+    // The column count is rounded up, so the last column may not fit on screen
+    main_buffer.view.width = SCREEN_WIDTH;
+    main_buffer.line_spacing = LINE_SPACING;
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    main_buffer.row_colors = main_row_colors;
+    text_buffer_set_row_colors(&main_buffer, 0, TEXT_ROWS, main_buffer.colors);
+#endif
+#if TEXT_MODE_ROW_FONTS
+    main_buffer.row_fonts = main_row_fonts;
+    main_buffer.line_map = main_line_map;
+    main_buffer.line_map_capacity = LINE_MAP_LINES;
+    if (!text_mode_row_map_update(&main_buffer, text_mode_current_font, 0))
+        printf("LINE_MAP_LINES is too small, so the bottom rows are cut off.\n");
+#ifdef CP437_TITLE
+    if (!text_mode_row_map_set_font(&main_buffer, text_mode_current_font, 0, &cp437))
+        printf("LINE_MAP_LINES has no room for the CP437 title row.\n");
+#endif
+#endif
     text_window title_window;
     text_window_ctor_in_place(&title_window, &main_buffer, (coord){ 0, 0 },
         (coord){ main_buffer.size.x, 2 }
     );
-#ifndef USE_CP437
+#if !defined(USE_CP437) && !defined(CP437_TITLE) && !defined(PIN_FONT)
+    // CP437 only has one font, and the pinned copy only has the start of the regular one.
     title_window.font = MONO_FONT_BOLD;
 #endif
     text_window_put_string_centered_line(&title_window, "The Picture of Dorian Gray");
     text_window_newline_no_scroll(&title_window);
+    // Does nothing without TEXT_MODE_CELL_STYLES.
+    text_window_set_style(&title_window, TEXT_STYLE_UNDERLINE);
     text_window_put_string_centered_line(&title_window, "Oscar Wilde");
     text_window main_window;
     text_window_ctor_in_place(&main_window, &main_buffer, (coord){ 0, title_window.size.y },
@@ -328,6 +750,36 @@ int main()
         "public excitement and gave rise to so many strange conjectures.\n"
     );
 
+#ifdef BENCHMARK_KERNELS
+    main_benchmark_kernels();
+#if TEXT_MODE_FONT_POOL_SIZE
+    main_benchmark_pinning();
+#endif
+#endif
+#ifdef PIN_FONT
+#if !TEXT_MODE_FONT_POOL_SIZE
+#error "Cannot pin the font because you forgot to set TEXT_MODE_FONT_POOL_SIZE in CMakeLists.txt."
+#endif
+    // The demo's text is all ASCII, so it never draws a glyph past the copy.
+    const text_mode_font* pinned_font = text_mode_pin_font(text_mode_current_font, PIN_FONT);
+    if (pinned_font)
+        text_mode_current_font = pinned_font;
+    else
+        printf("Font doesn't fit in TEXT_MODE_FONT_POOL_SIZE, so it stays in main RAM.\n");
+#endif
+
+    // Show the cursor where the text ends, without writing anything to the buffer.
+    main_cursor.position = coord_add(main_window.location, main_window.cursor);
+    text_mode_current_cursor = &main_cursor;
+    text_mode_current_sprite = &main_pointer;
+#if TEXT_MODE_OVERLAY && TEXT_MODE_COLOR_BITS >= 16
+    // Wider fonts leak the transparency bit into every foreground pixel, so they can't show through.
+    text_buffer_put_string(&status_buffer, "Overlay: no cells saved  ");
+    status_overlay.position.x = SCREEN_WIDTH - status_buffer.size.x * text_mode_current_font->scan_pixels;
+    status_overlay.position.y = SCREEN_HEIGHT - text_mode_current_font->scan_lines;
+    text_mode_current_overlay = &status_overlay;
+#endif
+
     // Rainbow effect to prove color works.
     //text_cell* cell = text_buffer_cell(text_mode_current_buffer, 0, 0);
     //for (int i = 0; i < text_mode_current_buffer->size.x * text_mode_current_buffer->size.y; i++, cell++) {
@@ -352,6 +804,10 @@ int main()
     scanvideo_timing_enable(true);
 #endif
     multicore_launch_core1(&text_mode_render_loop);
+#if TEXT_MODE_DUAL_CORE && !TEXT_MODE_LUT_KERNEL
+    // Core 0 renders scan lines in between loops too, with its own interpolator.
+    text_mode_setup_interp();
+#endif
     /// 800x480 TFT: Wait for LCD to sync with data stream before turning the backlight on
     sleep_ms(200);
     pwm_set_gpio_level(PWM_PIN, 8192);
@@ -360,13 +816,29 @@ int main()
     const int loop_period = 50*1000; // 20 Hz
     absolute_time_t next_loop = make_timeout_time_us(loop_period);
     unsigned blinker = 0;
+    int pointer_dx = 3, pointer_dy = 2;
     while (1) {
         if (blinker++ % (1000*1000 / loop_period) >= 1000*1000 / loop_period / 2)
             gpio_put(PICO_DEFAULT_LED_PIN, 1);
         else
             gpio_put(PICO_DEFAULT_LED_PIN, 0);
         next_loop = delayed_by_us(next_loop, loop_period);
-        // Put something interesting here.
+        // Bounce the pointer around the screen, which never touches the text under it.
+        if (main_pointer.position.x + pointer_dx < 0 || main_pointer.position.x + pointer_dx > SCREEN_WIDTH - 16)
+            pointer_dx = -pointer_dx;
+        if (main_pointer.position.y + pointer_dy < 0 || main_pointer.position.y + pointer_dy > SCREEN_HEIGHT - 16)
+            pointer_dy = -pointer_dy;
+        main_pointer.position.x += pointer_dx;
+        main_pointer.position.y += pointer_dy;
+#if TEXT_MODE_RENDER_STATS
+        if (blinker % (1000*1000 / loop_period) == 0)
+            main_print_stats();
+#endif
+#if TEXT_MODE_DUAL_CORE
+        while (!time_reached(next_loop))
+            text_mode_render_pending();
+#else
         sleep_until(next_loop);
+#endif
     }
 }
@@ -22,10 +22,19 @@
 #define MONO_FONT_DARK_GRAPHICS_GLYPH(x) ((x) + MONO_FONT_DARK_GRAPHICS_OFFSET)
 
 #define MONO_FONT_12_SECTION_ATTRIBUTE __not_in_flash("monofonts12normal")
+/**
+ * Type of each row of a glyph's bitmap: TEXT_MODE_FONT_DATA_TYPE, or with TEXT_MODE_PER_FONT_STORAGE,
+ * a byte, which the 8 pixel glyphs fit in.
+ */
+#if TEXT_MODE_PER_FONT_STORAGE
+#define MONO_FONT_DATA_TYPE unsigned char
+#else
+#define MONO_FONT_DATA_TYPE TEXT_MODE_FONT_DATA_TYPE
+#endif
 /**
  * Raw glyph bitmap data array.
  */
-extern const MONO_FONT_12_SECTION_ATTRIBUTE TEXT_MODE_FONT_DATA_TYPE mono_font_12_bitmaps_normal[MONO_FONTS_COUNT][MONO_FONT_GLYPH_COUNT][MONO_FONT_HEIGHT];
+extern const MONO_FONT_12_SECTION_ATTRIBUTE MONO_FONT_DATA_TYPE mono_font_12_bitmaps_normal[MONO_FONTS_COUNT][MONO_FONT_GLYPH_COUNT][MONO_FONT_HEIGHT];
 /**
  * 12-pixel-high monospaced font descriptor for text_mode rendering routine
  */
@@ -4,12 +4,16 @@ const MONO_FONT_12_SECTION_ATTRIBUTE struct text_mode_font mono_font_12_normal =
 {
     MONO_FONT_WIDTH, // scan_pixels
     MONO_FONT_HEIGHT, // scan_lines
-    sizeof(TEXT_MODE_FONT_DATA_TYPE), // bytes_per_scan
-    sizeof(TEXT_MODE_FONT_DATA_TYPE) * MONO_FONT_HEIGHT, // bytes_per_glyph
-    (void* const)&mono_font_12_bitmaps_normal[0][0][0] // data
+    sizeof(MONO_FONT_DATA_TYPE), // bytes_per_scan
+    sizeof(MONO_FONT_DATA_TYPE) * MONO_FONT_HEIGHT, // bytes_per_glyph
+    (void* const)&mono_font_12_bitmaps_normal[0][0][0], // data
+    MONO_FONTS_COUNT * MONO_FONT_GLYPH_COUNT, // glyph_count
+    sizeof(MONO_FONT_DATA_TYPE), // scan_line_stride
+    TEXT_MODE_FONT_GLYPH_MAJOR, // layout
+    NULL // blank_rows
 };
 
-const MONO_FONT_12_SECTION_ATTRIBUTE TEXT_MODE_FONT_DATA_TYPE mono_font_12_bitmaps_normal[MONO_FONTS_COUNT][MONO_FONT_GLYPH_COUNT][MONO_FONT_HEIGHT] = {
+const MONO_FONT_12_SECTION_ATTRIBUTE MONO_FONT_DATA_TYPE mono_font_12_bitmaps_normal[MONO_FONTS_COUNT][MONO_FONT_GLYPH_COUNT][MONO_FONT_HEIGHT] = {
 ////////////////////////////////////////////////////////////////////////////////
 /////// FONT 0 REGULAR /////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -6,11 +6,35 @@ void text_buffer_ctor_in_place(text_buffer* self, coord_x cols, coord_y rows)
 {
     self->size.x = cols;
     self->size.y = rows;
+    self->view.x = self->view.width = self->view.y = 0;
+    self->line_spacing = 0;
     self->cursor.y = self->cursor.x = 0;
     self->colors.foreground = 0;
     self->colors.background = 1;
     self->blank = ' ';
     self->font = 0;
+#if TEXT_MODE_CELL_STYLES
+    self->style = 0;
+#endif
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    self->row_colors = NULL;
+#endif
+#if TEXT_MODE_DOUBLE_SIZE_ROWS
+    self->row_sizes = NULL;
+#endif
+#if TEXT_MODE_ROW_FONTS
+    self->row_fonts = NULL;
+    self->line_map = NULL;
+    self->line_map_lines = 0;
+    self->line_map_capacity = 0;
+#endif
+#if TEXT_MODE_BITMAP_REGIONS
+    self->bitmaps = NULL;
+    self->bitmap_count = 0;
+#endif
+#if TEXT_MODE_TILE_ROWS
+    self->row_tiles = NULL;
+#endif
 }
 
 
@@ -34,14 +58,30 @@ void text_buffer_scroll_down_lines(text_buffer* self, unsigned n)
     size_t delta = self->size.x * n;
     size_t total_cells = self->size.x * self->size.y;
     memmove(self->buffer, self->buffer + delta, (total_cells - delta) * sizeof(text_cell));
-    text_cell blank = {
-        .glyph = self->blank,
-        .foreground = self->colors.foreground,
-        .background = self->colors.background
-    };
+    text_cell blank = TEXT_CELL_INIT(self->blank, self->colors.foreground, self->colors.background);
     text_cell* ptr = text_buffer_cell(self, 0, self->size.y - n);
     for (size_t i = 0; i < delta; i++)
         ptr[i] = blank;
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    if (self->row_colors) {
+        memmove(self->row_colors, self->row_colors + n, (self->size.y - n) * sizeof(color_pair));
+        text_buffer_set_row_colors(self, self->size.y - n, n, self->colors);
+    }
+#endif
+#if TEXT_MODE_DOUBLE_SIZE_ROWS
+    if (self->row_sizes) {
+        memmove(self->row_sizes, self->row_sizes + n, self->size.y - n);
+        memset(self->row_sizes + self->size.y - n, TEXT_ROW_NORMAL, n);
+    }
+#endif
+#if TEXT_MODE_TILE_ROWS
+    // Tile rows pick their tiles with the glyphs of their cells, so they go wherever the cells go.
+    if (self->row_tiles) {
+        memmove(self->row_tiles, self->row_tiles + n, (self->size.y - n) * sizeof(self->row_tiles[0]));
+        for (unsigned row = self->size.y - n; row < self->size.y; row++)
+            self->row_tiles[row] = NULL;
+    }
+#endif
 }
 
 
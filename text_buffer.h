@@ -32,9 +32,60 @@ typedef struct color_pair
     text_color background;
 } color_pair;
 
+/**
+ * Styles the scan line generator can draw a cell in without any extra glyphs, with TEXT_MODE_CELL_STYLES.
+ * These are bits, so they can be combined.
+ */
+typedef enum text_style
+{
+    /** Draws the font's underline scan line solid in the foreground color. */
+    TEXT_STYLE_UNDERLINE = 1,
+    /** Draws the font's strikethrough scan line solid in the foreground color. */
+    TEXT_STYLE_STRIKETHROUGH = 2,
+    /** Swaps the foreground and background colors. */
+    TEXT_STYLE_INVERSE = 4,
+    /** Draws the foreground at half brightness (see TEXT_MODE_HALF_BRIGHT_MASK); this applies after inverse. */
+    TEXT_STYLE_HALF_BRIGHT = 8,
+} text_style;
+
+/**
+ * How a text row is drawn, with TEXT_MODE_DOUBLE_SIZE_ROWS.
+ * These work like a DEC terminal's line attributes: a double size row only shows the left half of its cells,
+ * each drawn twice as wide, and a double height heading takes two rows holding the same text,
+ * one showing the top half of the glyphs and the other the bottom half.
+ */
+typedef enum text_row_size
+{
+    /** Drawn normally. */
+    TEXT_ROW_NORMAL = 0,
+    /** Every pixel of every cell is drawn twice. */
+    TEXT_ROW_DOUBLE_WIDTH = 1,
+    /** Double width, and each scan line of the top half of the glyphs is drawn twice. */
+    TEXT_ROW_DOUBLE_HEIGHT_TOP = 2,
+    /** Double width, and each scan line of the bottom half of the glyphs is drawn twice. */
+    TEXT_ROW_DOUBLE_HEIGHT_BOTTOM = 3,
+} text_row_size;
+
+/**
+ * Where one scan line of a text buffer falls, as an entry of text_buffer.line_map with TEXT_MODE_ROW_FONTS.
+ */
+typedef struct text_row_line
+{
+    /** Text row the scan line is part of. */
+    uint16_t row;
+    /** Scan line within the row, counting from its top; lines past the height of the row's font are spacing lines. */
+    uint16_t line;
+} text_row_line;
+
+struct text_mode_font;
+
 /**
  * A single cell in the text buffer.
  * Has font and color information for the cell along with a character code.
+ * With TEXT_MODE_GLYPH_ONLY_CELLS, cells only have the character code and font,
+ * and colors come from text_buffer_row_colors() instead.
+ * With TEXT_MODE_CELL_STYLES, cells also have a byte of text_style bits, which costs two bytes per cell
+ * after padding.
  */
 typedef struct text_cell
 {
@@ -49,27 +100,199 @@ typedef struct text_cell
         /** Character code and font ID together as a single item.  (Used for pseudographics.)*/
         text_glyph glyph;
     };
+#if !TEXT_MODE_GLYPH_ONLY_CELLS
     /** Foreground color of cell */
     text_color foreground;
     /** Background color of cell */
     text_color background;
+#endif
+#if TEXT_MODE_CELL_STYLES
+    /** text_style bits of the cell */
+    unsigned char style;
+#endif
 } text_cell;
 
+/**
+ * Initializer for a text_cell.
+ * The colors are dropped with TEXT_MODE_GLYPH_ONLY_CELLS.
+ */
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+#define TEXT_CELL_INIT(GLYPH, FG, BG) { .glyph = (GLYPH) }
+#else
+#define TEXT_CELL_INIT(GLYPH, FG, BG) { .glyph = (GLYPH), .foreground = (FG), .background = (BG) }
+#endif
+
+/**
+ * Returns a cell's colors.
+ * @param row_colors Colors of the cell's row, from text_buffer_row_colors(), which is what is returned
+ * with TEXT_MODE_GLYPH_ONLY_CELLS
+ */
+static inline color_pair text_cell_colors(const text_cell* cell, color_pair row_colors)
+{
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    (void)cell;
+    return row_colors;
+#else
+    (void)row_colors;
+    return (color_pair){ cell->foreground, cell->background };
+#endif
+}
+
+/**
+ * Sets a cell's colors.
+ * Does nothing with TEXT_MODE_GLYPH_ONLY_CELLS, since cells don't have colors then.
+ */
+static inline void text_cell_set_colors(text_cell* cell, color_pair colors)
+{
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    (void)cell;
+    (void)colors;
+#else
+    cell->foreground = colors.foreground;
+    cell->background = colors.background;
+#endif
+}
+
+/**
+ * Returns a cell's text_style bits, which are always 0 without TEXT_MODE_CELL_STYLES.
+ */
+static inline unsigned text_cell_style(const text_cell* cell)
+{
+#if TEXT_MODE_CELL_STYLES
+    return cell->style;
+#else
+    (void)cell;
+    return 0;
+#endif
+}
+
+/**
+ * Sets a cell's text_style bits.
+ * Does nothing without TEXT_MODE_CELL_STYLES.
+ */
+static inline void text_cell_set_style(text_cell* cell, unsigned style)
+{
+#if TEXT_MODE_CELL_STYLES
+    cell->style = style;
+#else
+    (void)cell;
+    (void)style;
+#endif
+}
+
+/**
+ * Part of a text buffer that the scan line generators show.
+ * This is in pixels because that's what smooth scrolling needs, and the buffer doesn't know its font.
+ */
+typedef struct text_buffer_view
+{
+    /**
+     * Pixel column of the buffer shown at the left edge of each scan line.
+     * Anything that isn't a multiple of the font's width cuts off the left part of the first cell shown.
+     */
+    unsigned x;
+    /**
+     * Number of pixels shown on each scan line, normally the width of the video mode,
+     * or 0 to show everything from x to the right edge of the buffer.
+     * This is also limited to the right edge of the buffer, and the last cell shown is cut off to fit.
+     */
+    unsigned width;
+    /**
+     * Scan line of the buffer shown at the top of the screen.
+     * Anything that isn't a multiple of the font's height cuts off the top part of the first row shown.
+     * Lines past the bottom of the buffer wrap around to its top, so the buffer can be used as a ring of rows.
+     */
+    unsigned y;
+} text_buffer_view;
+
 typedef struct text_buffer
 {
     /** Size of the text buffer. */
     coord size;
+    /**
+     * Part of the buffer that is shown.
+     * This is latched once per line, so it can be changed at any time, such as for smooth scrolling.
+     */
+    text_buffer_view view;
+    /**
+     * Number of blank scan lines drawn below each text row, in the background colors of the row's cells.
+     * Each row then takes the font's height plus this many scan lines, without any extra font data,
+     * and the spacing lines are sent to scanvideo as color runs, so they cost almost nothing to render.
+     */
+    unsigned char line_spacing;
     /**
      * Current default cursor location. 
      * The default cursor is used for writing routines.
      */
     coord cursor;
-    /** Current foreground and background colors for writing text. */
+    /**
+     * Current foreground and background colors for writing text.
+     * With TEXT_MODE_GLYPH_ONLY_CELLS, this is what the whole buffer is drawn in, unless row_colors is set.
+     */
     color_pair colors;
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    /**
+     * Optional array of colors for each row, or NULL to draw every row in colors.
+     * This is supplied by the owner of the buffer, which must keep it around as long as the buffer.
+     */
+    color_pair* row_colors;
+#endif
+#if TEXT_MODE_DOUBLE_SIZE_ROWS
+    /**
+     * Optional array of the text_row_size of each row, or NULL to draw every row normally.
+     * This is supplied by the owner of the buffer, which must keep it around as long as the buffer.
+     */
+    unsigned char* row_sizes;
+#endif
+#if TEXT_MODE_ROW_FONTS
+    /**
+     * Optional array of the font of each row, or NULL to draw every row in the font the buffer is rendered with,
+     * which is also what NULL entries use.
+     * Rows in a taller or shorter font take more or fewer scan lines, so this needs line_map.
+     * Fonts belong to the row positions rather than the text, so they stay put when the buffer scrolls,
+     * and so does line_map, which text_buffer_scroll_down_lines() couldn't rebuild without the font.
+     * This is supplied by the owner of the buffer, which must keep it around as long as the buffer.
+     */
+    const struct text_mode_font** row_fonts;
+    /**
+     * Optional map from each scan line of the buffer to the row and line of the row it shows,
+     * built by text_mode_row_map_update(), or NULL to work that out with a divide,
+     * which only works if every row is the same height.
+     * This is supplied by the owner of the buffer, which must keep it around as long as the buffer.
+     */
+    text_row_line* line_map;
+    /** Number of entries in line_map, which is the height of the buffer in scan lines. */
+    unsigned short line_map_lines;
+    /** Number of entries line_map has room for, which is supplied along with it. */
+    unsigned short line_map_capacity;
+#endif
+#if TEXT_MODE_BITMAP_REGIONS
+    /**
+     * Optional array of bitmap_count regions drawn from bitmaps instead of from their cells,
+     * or NULL for none. Regions shouldn't overlap. See text_mode_bitmap.h.
+     * This is supplied by the owner of the buffer, which must keep it around as long as the buffer.
+     */
+    const struct text_mode_bitmap* bitmaps;
+    /** Number of entries in bitmaps. */
+    unsigned char bitmap_count;
+#endif
+#if TEXT_MODE_TILE_ROWS
+    /**
+     * Optional array of the tiles each row is drawn from, or NULL to draw every row as text,
+     * which is also what NULL entries do. See text_mode_tile.h.
+     * text_buffer_scroll_down_lines() moves these along with the rows, and the rows it clears are text.
+     * This is supplied by the owner of the buffer, which must keep it around as long as the buffer.
+     */
+    const struct text_mode_tiles** row_tiles;
+#endif
     /** Value used as a blank character. */
     text_glyph blank;
     /** Current font ID for writing text. */
     unsigned char font;
+#if TEXT_MODE_CELL_STYLES
+    /** Current text_style bits for writing text. */
+    unsigned char style;
+#endif
     /** Raw text buffer */
     text_cell buffer[];
 } text_buffer;
@@ -91,11 +314,7 @@ typedef struct text_buffer
     .blank = BLANK, \
     .font = FONT, \
     .buffer = { \
-        [0 ... COLS * ROWS - 1] = { \
-            .glyph = BLANK, \
-            .foreground = FG, \
-            .background = BG \
-        } \
+        [0 ... COLS * ROWS - 1] = TEXT_CELL_INIT(BLANK, FG, BG) \
     } \
 }
 
@@ -136,6 +355,75 @@ static inline void text_buffer_set_colors(text_buffer* self, text_color foregrou
     self->colors.background = background;
 }
 
+/**
+ * Returns the text_style bits used for writing, which are always 0 without TEXT_MODE_CELL_STYLES.
+ */
+static inline unsigned text_buffer_style(const text_buffer* self)
+{
+#if TEXT_MODE_CELL_STYLES
+    return self->style;
+#else
+    (void)self;
+    return 0;
+#endif
+}
+
+/**
+ * Sets the text_style bits that will be used for writing.
+ * Does nothing without TEXT_MODE_CELL_STYLES.
+ */
+static inline void text_buffer_set_style(text_buffer* self, unsigned style)
+{
+#if TEXT_MODE_CELL_STYLES
+    self->style = style;
+#else
+    (void)self;
+    (void)style;
+#endif
+}
+
+/**
+ * Returns the text_row_size of a row, which is always TEXT_ROW_NORMAL without TEXT_MODE_DOUBLE_SIZE_ROWS.
+ */
+static inline text_row_size text_buffer_row_size(const text_buffer* self, coord_y row)
+{
+#if TEXT_MODE_DOUBLE_SIZE_ROWS
+    if (self->row_sizes)
+        return self->row_sizes[row];
+#else
+    (void)self;
+    (void)row;
+#endif
+    return TEXT_ROW_NORMAL;
+}
+
+/**
+ * Returns the colors a row is drawn in with TEXT_MODE_GLYPH_ONLY_CELLS.
+ * Without it, cells have their own colors and this just returns the current writing colors.
+ */
+static inline color_pair text_buffer_row_colors(const text_buffer* self, coord_y row)
+{
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    if (self->row_colors)
+        return self->row_colors[row];
+#else
+    (void)row;
+#endif
+    return self->colors;
+}
+
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+/**
+ * Sets the colors of a range of rows.
+ * The buffer must have row_colors.
+ */
+static inline void text_buffer_set_row_colors(text_buffer* self, coord_y first, unsigned count, color_pair colors)
+{
+    for (color_pair* row = self->row_colors + first; count > 0; count--)
+        *row++ = colors;
+}
+#endif
+
 /**
  * Returns a pointer to the cell the cursor currently points to.
  */
@@ -280,8 +568,8 @@ static inline void text_buffer_put_char(text_buffer* self, char ch)
     text_cell* cell = text_buffer_cursor_next_circular(self);
     cell->char_font.character = ch;
     cell->char_font.font_id = self->font;
-    cell->foreground = self->colors.foreground;
-    cell->background = self->colors.background;
+    text_cell_set_colors(cell, self->colors);
+    text_cell_set_style(cell, text_buffer_style(self));
 }
 
 /**
@@ -291,8 +579,8 @@ static inline void text_buffer_put_glyph(text_buffer* self, text_glyph ch)
 {
     text_cell* cell = text_buffer_cursor_next_circular(self);
     cell->glyph = ch;
-    cell->foreground = self->colors.foreground;
-    cell->background = self->colors.background;
+    text_cell_set_colors(cell, self->colors);
+    text_cell_set_style(cell, text_buffer_style(self));
 }
 
 /**
@@ -334,11 +622,7 @@ static inline void text_buffer_overwrite_glyph(text_buffer* self, text_glyph ch)
 /** Erases the entire buffer, using current colors. */
 static inline void text_buffer_erase(text_buffer* self)
 {
-    text_cell empty = {
-        .glyph = self->blank,
-        .foreground = self->colors.foreground,
-        .background = self->colors.background
-    };
+    text_cell empty = TEXT_CELL_INIT(self->blank, self->colors.foreground, self->colors.background);
     text_cell* cell = self->buffer;
     for (unsigned i = self->size.x * self->size.y; i > 0; i--)
         *cell++ = empty;
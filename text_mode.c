@@ -1,48 +1,547 @@
 #include "text_mode.h"
 #include "pico/scanvideo/scanvideo_base.h"
 #include "hardware/interp.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#if TEXT_MODE_RENDER_STATS
+#include "hardware/timer.h"
+#endif
+#include "text_mode_interp.h"
+#include "text_mode_row_cache.h"
+#include "text_mode_attr_runs.h"
+#include "text_mode_composable.h"
+#include "text_mode_runs.h"
+#include "text_mode_lut.h"
+#include "text_mode_clip.h"
+#include "text_mode_cursor.h"
+#include "text_mode_sprite.h"
+#include "text_mode_overlay.h"
+#include "text_mode_bitmap.h"
+#include "text_mode_tile.h"
 
 text_buffer* volatile text_mode_current_buffer;
 const text_mode_font* volatile text_mode_current_font;
 #if TEXT_MODE_PALETTIZED_COLOR
 uint16_t* volatile text_mode_current_palette;
 #endif
+const text_mode_cursor* volatile text_mode_current_cursor;
+const text_mode_sprite* volatile text_mode_current_sprite;
+#if TEXT_MODE_OVERLAY
+const text_mode_overlay* volatile text_mode_current_overlay;
+#endif
+
+#if TEXT_MODE_DUAL_CORE && (TEXT_MODE_ROW_CACHE || TEXT_MODE_ATTR_RUNS)
+#error TEXT_MODE_DUAL_CORE cannot be used with TEXT_MODE_ROW_CACHE or TEXT_MODE_ATTR_RUNS, which only keep one copy of their state.
+#endif
+
+/**
+ * Bytes of the 4 K scratch X bank the renderer can have.
+ * The SDK's default linker script puts core 1's stack, PICO_CORE1_STACK_SIZE bytes, in the same bank.
+ */
+#define TEXT_MODE_SCRATCH_X_BUDGET (4096 - PICO_CORE1_STACK_SIZE)
+
+#if TEXT_MODE_ROW_CACHE
+#define TEXT_MODE_SCRATCH_X_ROW_CACHE sizeof(text_mode_row_cache)
+#else
+#define TEXT_MODE_SCRATCH_X_ROW_CACHE 0
+#endif
+#if TEXT_MODE_ATTR_RUNS
+#define TEXT_MODE_SCRATCH_X_ATTR_RUNS sizeof(text_mode_attr_row)
+#else
+#define TEXT_MODE_SCRATCH_X_ATTR_RUNS 0
+#endif
 
+_Static_assert(TEXT_MODE_SCRATCH_X_ROW_CACHE + TEXT_MODE_SCRATCH_X_ATTR_RUNS + TEXT_MODE_FONT_POOL_SIZE
+        <= TEXT_MODE_SCRATCH_X_BUDGET,
+    "TEXT_MODE_ROW_CACHE, TEXT_MODE_ATTR_RUNS, and TEXT_MODE_FONT_POOL_SIZE don't fit in scratch X next to core 1's stack; "
+    "lower TEXT_MODE_FONT_POOL_SIZE, TEXT_MODE_ROW_CACHE_MAX_COLS, or TEXT_MODE_ATTR_RUNS_MAX_COLS, or turn one off");
 
+#if TEXT_MODE_RENDER_STATS
+volatile text_mode_render_stats text_mode_core_stats[NUM_CORES];
+#endif
+
+#if TEXT_MODE_OVERLAY
+/** Scratch lines the overlay's scan lines are rendered into before they're merged, one for each rendering core. */
+static uint16_t text_mode_overlay_pixels[TEXT_MODE_DUAL_CORE ? NUM_CORES : 1][TEXT_MODE_OVERLAY_MAX_PIXELS];
+#endif
+
+#if TEXT_MODE_FONT_POOL_SIZE
 /**
- * Declares a function to be placed in the scratch Y RAM bank, which is usually dedicated to core 1's
- * stack.
+ * Fonts copied by text_mode_pin_font(), each a descriptor followed by its bitmaps.
+ * Scratch X is a bank of its own, so glyph reads from here never wait behind core 0's accesses to main RAM.
+ * It only has TEXT_MODE_SCRATCH_X_BUDGET bytes to share with the row cache and attribute runs.
+ */
+static uint32_t __scratch_x("text_mode_font_pool") text_mode_font_pool[TEXT_MODE_FONT_POOL_SIZE / sizeof(uint32_t)];
+/** Bytes of text_mode_font_pool handed out so far. */
+static size_t text_mode_font_pool_used;
+
+
+const text_mode_font* text_mode_pin_font(const text_mode_font* font, unsigned glyph_count)
+{
+    if (!glyph_count || glyph_count > font->glyph_count)
+        glyph_count = font->glyph_count;
+    // Rounding up to whole words keeps the next font's descriptor aligned.
+    size_t data_size = ((size_t)glyph_count * font->scan_lines * font->bytes_per_scan + 3) & ~(size_t)3;
+    size_t size = sizeof(text_mode_font) + data_size;
+    if (size > sizeof(text_mode_font_pool) - text_mode_font_pool_used)
+        return NULL;
+    unsigned char* place = (unsigned char*)text_mode_font_pool + text_mode_font_pool_used;
+    text_mode_font* pinned = (text_mode_font*)place;
+    text_mode_font_relocate(pinned, place + sizeof(text_mode_font), font, glyph_count);
+    text_mode_font_pool_used += size;
+    return pinned;
+}
+
+
+void text_mode_unpin_fonts(void)
+{
+    text_mode_font_pool_used = 0;
+}
+#endif
+
+
+/**
+ * Declares a function to be placed in the scratch Y RAM bank, which the SDK's default linker script otherwise
+ * only uses for core 0's stack.
  */
 #define CORE_1_FUNC(FUNC_NAME) __scratch_y(#FUNC_NAME) FUNC_NAME
 
 
-#define SHIFT_AMOUNT ((TEXT_MODE_MAX_FONT_WIDTH) <= 15 ? 17 : 17 - ((TEXT_MODE_MAX_FONT_WIDTH) - 15))
+/** Stringizes a macro's value for use in inline assembly. */
+#define XSTR(x) STR(x)
+#define STR(x) #x
+#define CONCAT(a, b) CONCAT2(a, b)
+#define CONCAT2(a, b) a ## b
+
+
+/** Defines the assembler symbol shiftamount as TEXT_MODE_SHIFT_AMOUNT. */
+#if TEXT_MODE_MAX_FONT_WIDTH <= 15 || TEXT_MODE_SPLIT_DECODE
+#define SHIFT_AMOUNT_SYMBOL "shiftamount = 17\n"
+#else
+#define SHIFT_AMOUNT_SYMBOL "shiftamount = 17 - (" XSTR(TEXT_MODE_MAX_FONT_WIDTH) " - 15)\n"
+#endif
+
+/**
+ * Loads one row of glyph bits from an address into a register, with ldrb, ldrh, or ldr for the constant
+ * %[glyphbytes] operand, which is text_mode_font_storage().
+ * The assembler picks the instruction, so there's no cost per glyph, and each is the same size.
+ */
+#define GLYPH_LOAD(dest, address) \
+"    .if %c[glyphbytes] == 1\n" \
+"    ldrb    " dest ", " address "\n" \
+"    .elseif %c[glyphbytes] == 2\n" \
+"    ldrh    " dest ", " address "\n" \
+"    .else\n" \
+"    ldr     " dest ", " address "\n" \
+"    .endif\n"
+
+/**
+ * Calls an always inline kernel body with text_mode_font_storage() for a font as its first argument,
+ * as a constant for GLYPH_LOAD, so each storage width gets its own copy of the kernel, and a span of cells
+ * picks one with a single check.
+ * Only the widths in GLYPH_BYTES_USED get a copy, so without TEXT_MODE_PER_FONT_STORAGE there's just one.
+ */
+#if TEXT_MODE_PER_FONT_STORAGE
+/** TEXT_MODE_FONT_STORAGE_WIDTHS, less the widths wider than TEXT_MODE_FONT_DATA_TYPE. */
+#define GLYPH_BYTES_USED (TEXT_MODE_FONT_STORAGE_WIDTHS & (2 * sizeof(TEXT_MODE_FONT_DATA_TYPE) - 1))
+_Static_assert(GLYPH_BYTES_USED, "TEXT_MODE_FONT_STORAGE_WIDTHS has no width TEXT_MODE_FONT_DATA_TYPE allows.");
+#define GLYPH_BYTES_DISPATCH(font, kernel, ...) \
+    (GLYPH_BYTES_USED == 1 || (GLYPH_BYTES_USED & 1 && text_mode_font_storage(font) == 1) ? kernel(1, __VA_ARGS__) \
+    : GLYPH_BYTES_USED < 4 || (GLYPH_BYTES_USED & 2 && text_mode_font_storage(font) == 2) ? kernel(2, __VA_ARGS__) \
+    : kernel(4, __VA_ARGS__))
+#else
+#define GLYPH_BYTES_DISPATCH(font, kernel, ...) kernel(sizeof(TEXT_MODE_FONT_DATA_TYPE), __VA_ARGS__)
+#endif
+
+/**
+ * Defines assembler symbols for the offsets of the decoder's interpolator registers from %[interp],
+ * which points at TEXT_MODE_DECODE_INTERP.
+ * With TEXT_MODE_SPLIT_DECODE, that's INTERP0, which cuts glyph rows into passes,
+ * and INTERP1's registers, which do the decoding, follow it.
+ */
+#if TEXT_MODE_SPLIT_DECODE
+#define TEXT_MODE_DECODE_INTERP interp0_hw
+#define INTERP_SYMBOLS \
+    "split_accum0 = 0\n" \
+    "split_accum1 = 4\n" \
+    "split_peek0 = 32\n" \
+    "split_peek1 = 36\n" \
+    "accum0 = 64 + 0\n" \
+    "accum1 = 64 + 4\n" \
+    "base0 = 64 + 8\n" \
+    "base1 = 64 + 12\n" \
+    "pop0 = 64 + 20\n"
+#else
+#define TEXT_MODE_DECODE_INTERP interp1_hw
+#define INTERP_SYMBOLS \
+    "accum0 = 0\n" \
+    "accum1 = 4\n" \
+    "base0 = 8\n" \
+    "base1 = 12\n" \
+    "pop0 = 20\n"
+#endif
+
+/**
+ * Defines assembler symbols for the offsets of a text_cell's members from a cell pointer,
+ * and CELL_SIZE as the size of a text_cell.
+ * TEXT_MODE_CELL_STYLES adds a style byte after the colors, which pads each cell out by two bytes.
+ */
+#if TEXT_MODE_CELL_STYLES
+#define CELL_STYLE_SIZE 2
+#else
+#define CELL_STYLE_SIZE 0
+#endif
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+#define CELL_SIZE (2 + CELL_STYLE_SIZE)
+#define CELL_SYMBOLS \
+    "cellchar = 0\n" \
+    "cellsize = " XSTR(CELL_SIZE) "\n"
+#elif !TEXT_MODE_PALETTIZED_COLOR
+#define CELL_SIZE (6 + CELL_STYLE_SIZE)
+#define CELL_SYMBOLS \
+    "cellchar = 0\n" \
+    "cellfg = 2\n" \
+    "cellbg = 4\n" \
+    "cellsize = " XSTR(CELL_SIZE) "\n"
+#else
+#define CELL_SIZE (4 + CELL_STYLE_SIZE)
+#define CELL_SYMBOLS \
+    "cellchar = 0\n" \
+    "cellfg = 2\n" \
+    "cellbg = 3\n" \
+    "cellsize = " XSTR(CELL_SIZE) "\n"
+#endif
+
+/**
+ * With TEXT_MODE_SPLIT_DECODE, hands the raw glyph row in a register to INTERP0 to be cut into passes.
+ * Does nothing otherwise.
+ */
+#if TEXT_MODE_SPLIT_DECODE
+#define SPLIT_ROW(reg) \
+"    str     " reg ", [%[interp], #split_accum0]\n" \
+"    str     " reg ", [%[interp], #split_accum1]\n"
+#else
+#define SPLIT_ROW(reg)
+#endif
+
+/** Loads the glyph row at r7 bytes past %[font] into r7. */
+#define LOAD_GLYPH_ROW GLYPH_LOAD("r7", "[%[font], r7]") SPLIT_ROW("r7")
 
+/**
+ * With TEXT_MODE_SPLIT_DECODE, starts the next pass of a glyph row by reloading the accumulators
+ * from one of INTERP0's lanes.
+ * This is SPLIT_PASS_SIZE bytes of code.
+ * Does nothing otherwise.
+ */
+#if TEXT_MODE_SPLIT_DECODE
+#define SPLIT_PASS(peek) \
+"    ldr     r7, [%[interp], #" peek "]\n" \
+"    lsl     r7, r7, #shiftamount\n" \
+"    str     r7, [%[interp], #accum0]\n" \
+"    str     r7, [%[interp], #accum1]\n"
+#define SPLIT_PASS_SIZE 8
+#else
+#define SPLIT_PASS(peek)
+#endif
 
-#if TEXT_MODE_MAX_FONT_WIDTH > 30
-#error "TEXT_MODE_MAX_FONT_WIDTH must be less than 31."
+/**
+ * Decodes and stores one pixel.
+ * Each of these is four bytes of code, which is what the loop entry jump is computed from.
+ */
+#define handlebit(bit) "    ldr     r7, [%[interp], #pop0]\n" \
+"    strh    r7, [%[write], #(" #bit " * 2)]\n"
+/** Same as handlebit(), but for the second line of a pair. */
+#define handlebit_write1(bit) "    ldr     r7, [%[interp], #pop0]\n" \
+"    strh    r7, [%[write1], #(" #bit " * 2)]\n"
+#define UNROLLED_BITS_1(h) h(0)
+#define UNROLLED_BITS_2(h) h(1) UNROLLED_BITS_1(h)
+#define UNROLLED_BITS_3(h) h(2) UNROLLED_BITS_2(h)
+#define UNROLLED_BITS_4(h) h(3) UNROLLED_BITS_3(h)
+#define UNROLLED_BITS_5(h) h(4) UNROLLED_BITS_4(h)
+#define UNROLLED_BITS_6(h) h(5) UNROLLED_BITS_5(h)
+#define UNROLLED_BITS_7(h) h(6) UNROLLED_BITS_6(h)
+#define UNROLLED_BITS_8(h) h(7) UNROLLED_BITS_7(h)
+#define UNROLLED_BITS_9(h) h(8) UNROLLED_BITS_8(h)
+#define UNROLLED_BITS_10(h) h(9) UNROLLED_BITS_9(h)
+#define UNROLLED_BITS_11(h) h(10) UNROLLED_BITS_10(h)
+#define UNROLLED_BITS_12(h) h(11) UNROLLED_BITS_11(h)
+#define UNROLLED_BITS_13(h) h(12) UNROLLED_BITS_12(h)
+#define UNROLLED_BITS_14(h) h(13) UNROLLED_BITS_13(h)
+#define UNROLLED_BITS_15(h) h(14) UNROLLED_BITS_14(h)
+#define UNROLLED_BITS_16(h) h(15) SPLIT_PASS("split_peek0") UNROLLED_BITS_15(h)
+#define UNROLLED_BITS_17(h) h(16) UNROLLED_BITS_16(h)
+#define UNROLLED_BITS_18(h) h(17) UNROLLED_BITS_17(h)
+#define UNROLLED_BITS_19(h) h(18) UNROLLED_BITS_18(h)
+#define UNROLLED_BITS_20(h) h(19) UNROLLED_BITS_19(h)
+#define UNROLLED_BITS_21(h) h(20) UNROLLED_BITS_20(h)
+#define UNROLLED_BITS_22(h) h(21) UNROLLED_BITS_21(h)
+#define UNROLLED_BITS_23(h) h(22) UNROLLED_BITS_22(h)
+#define UNROLLED_BITS_24(h) h(23) UNROLLED_BITS_23(h)
+#define UNROLLED_BITS_25(h) h(24) UNROLLED_BITS_24(h)
+#define UNROLLED_BITS_26(h) h(25) UNROLLED_BITS_25(h)
+#define UNROLLED_BITS_27(h) h(26) UNROLLED_BITS_26(h)
+#define UNROLLED_BITS_28(h) h(27) UNROLLED_BITS_27(h)
+#define UNROLLED_BITS_29(h) h(28) UNROLLED_BITS_28(h)
+#define UNROLLED_BITS_30(h) h(29) UNROLLED_BITS_29(h)
+#define UNROLLED_BITS_31(h) h(30) SPLIT_PASS("split_peek1") UNROLLED_BITS_30(h)
+#define UNROLLED_BITS_32(h) h(31) UNROLLED_BITS_31(h)
+#if TEXT_MODE_MAX_FONT_WIDTH < 1
+#error "TEXT_MODE_MAX_FONT_WIDTH is less than one???"
 #endif
+/**
+ * One h() for each possible pixel, from the rightmost pixel of the widest font down to the leftmost.
+ * Narrower fonts jump into the middle of this, at text_mode_loop_entry().
+ * With TEXT_MODE_SPLIT_DECODE, a SPLIT_PASS() precedes every TEXT_MODE_SPLIT_PIXELS pixels from the left.
+ * @param h handlebit or handlebit_write1
+ */
+#define UNROLLED_BITS(h) CONCAT(UNROLLED_BITS_, TEXT_MODE_MAX_FONT_WIDTH)(h)
+
+
+/**
+ * Returns the palette to render with, or NULL if palettized mode is off.
+ */
+static inline const uint16_t* text_mode_latch_palette(void)
+{
+#if TEXT_MODE_PALETTIZED_COLOR
+    return text_mode_current_palette;
+#else
+    return NULL;
+#endif
+}
+
+
+/**
+ * With TEXT_MODE_GLYPH_ONLY_CELLS, loads the interpolator's bases with the colors every cell of a span shares,
+ * so the kernels don't fetch any per cell.
+ * Does nothing otherwise.
+ */
+static inline void text_mode_load_colors(color_pair colors, const uint16_t* palette)
+{
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+#if TEXT_MODE_PALETTIZED_COLOR
+    interp1_hw->base[1] = palette[colors.foreground] + TEXT_MODE_EMBIGGENER;
+    interp1_hw->base[0] = palette[colors.background];
+#else
+    (void)palette;
+    interp1_hw->base[1] = colors.foreground + TEXT_MODE_EMBIGGENER;
+    interp1_hw->base[0] = colors.background;
+#endif
+#else
+    (void)colors;
+    (void)palette;
+#endif
+}
+
+
+/**
+ * Returns how many bytes into UNROLLED_BITS() decoding a font's cells starts, plus one for Thumb mode.
+ * With TEXT_MODE_SPLIT_DECODE, this also sets INTERP0 up to cut the font's glyph rows into passes,
+ * so it must be called on the render core.
+ */
+static inline int text_mode_loop_entry(const text_mode_font* font)
+{
+    unsigned width = font->scan_pixels;
+    int entry = 4 * (TEXT_MODE_MAX_FONT_WIDTH - width) + 1;
+#if TEXT_MODE_SPLIT_DECODE
+    text_mode_configure_split_interp(interp0, width);
+    // Narrower fonts skip the passes they don't need along with their pixels.
+    for (unsigned pass = TEXT_MODE_SPLIT_PIXELS; pass < TEXT_MODE_MAX_FONT_WIDTH; pass += TEXT_MODE_SPLIT_PIXELS)
+        if (width <= pass)
+            entry += SPLIT_PASS_SIZE;
+#endif
+    return entry;
+}
 
 
 void text_mode_setup_interp(void)
 {
     interp_claim_lane_mask(interp1, 3);
-    interp_config lane0 = interp_default_config();
-    interp_config_set_shift(&lane0, 0);
-    interp_config_set_mask(&lane0, SHIFT_AMOUNT, SHIFT_AMOUNT);
-    interp_config_set_clamp(&lane0, true);
-    interp_config_set_cross_result(&lane0, true);
-    interp_set_config(interp1, 0, &lane0);
-    interp_config lane1 = interp_default_config();
-    interp_config_set_shift(&lane1, 1);
-    interp_config_set_mask(&lane1, SHIFT_AMOUNT, 31);
-    interp_set_config(interp1, 1, &lane1);
+    text_mode_configure_interp(interp1, TEXT_MODE_SHIFT_AMOUNT);
+#if TEXT_MODE_SPLIT_DECODE
+    interp_claim_lane_mask(interp0, 3);
+#endif
 }
 
 
 void text_mode_release_interp(void)
 {
         interp_unclaim_lane_mask(interp1, 3);
+#if TEXT_MODE_SPLIT_DECODE
+        interp_unclaim_lane_mask(interp0, 3);
+#endif
+}
+
+
+/** Kernel the render loop uses for spans of cells. */
+#if TEXT_MODE_LUT_KERNEL
+#define TEXT_MODE_CELLS_KERNEL text_mode_lut_generate_cells
+#else
+#define TEXT_MODE_CELLS_KERNEL text_mode_generate_cells
+#endif
+
+
+/**
+ * Internal routine: Adds the end of line token and hands the buffer back to scanvideo.
+ */
+static inline void text_mode_finish_scanline(struct scanvideo_scanline_buffer* buffer, uint16_t* write)
+{
+    uint16_t* start = (uint16_t*)buffer->data;
+    write = text_mode_end_scanline(start, write);
+    buffer->data_used = (uint32_t*)write - buffer->data;
+    buffer->status = SCANLINE_OK;
+    scanvideo_end_scanline_generation(buffer);
+}
+
+
+#if TEXT_MODE_OVERLAY
+/**
+ * Internal routine: Renders the overlay's part of a scan line into a scratch line and merges it over the line.
+ * @param line First pixel of the scan line
+ * @param end End of the scan line's pixels
+ */
+static inline void text_mode_draw_overlay(uint16_t* line, const uint16_t* end, const text_mode_overlay* overlay,
+    unsigned scanline, const text_mode_font* font)
+{
+    if (!text_mode_overlay_on_line(overlay, scanline, font) || !text_mode_overlay_fits(overlay, font))
+        return;
+    unsigned overlay_line = text_mode_overlay_scanline(overlay, scanline);
+#if TEXT_MODE_DUAL_CORE
+    uint16_t* pixels = text_mode_overlay_pixels[get_core_num()];
+#else
+    uint16_t* pixels = text_mode_overlay_pixels[0];
+#endif
+#if TEXT_MODE_LUT_KERNEL
+    uint16_t* pixels_end = text_mode_lut_generate_line(pixels, overlay_line, overlay->buffer, font,
+        text_mode_latch_palette());
+#else
+    uint16_t* pixels_end = text_mode_generate_line(pixels, overlay_line, overlay->buffer, font);
+#endif
+    text_mode_overlay_merge(line, end, overlay, pixels, pixels_end);
+}
+#else
+/** Without TEXT_MODE_OVERLAY, there's no overlay to draw. */
+#define text_mode_draw_overlay(line, end, overlay, scanline, font) ((void)(overlay))
+#endif
+
+
+/**
+ * Internal routine: Renders one scan line into a buffer and hands it back to scanvideo.
+ * The cursor is drawn over the text, the overlay over that, and the sprite over everything.
+ */
+static inline void text_mode_render_scanline(struct scanvideo_scanline_buffer* buffer, text_buffer* screen,
+    const text_mode_font* font, const text_mode_cursor* cursor, const text_mode_sprite* sprite,
+    const text_mode_overlay* overlay)
+{
+    uint16_t* start = (uint16_t*)buffer->data;
+    unsigned scanline = scanvideo_scanline_number(buffer->scanline_id);
+    unsigned frame = scanvideo_frame_number(buffer->scanline_id);
+    // The cursor, overlay, and sprite are drawn into a raw run's pixels, so lines that show them are rendered as one.
+    bool layered = text_mode_cursor_on_line(cursor, scanline, frame, screen, font)
+        || text_mode_overlay_on_line(overlay, scanline, font) || text_mode_sprite_on_line(sprite, scanline);
+#if TEXT_MODE_BLANK_RUNS
+    if (!layered) {
+        const uint16_t* palette = text_mode_latch_palette();
+        text_mode_finish_scanline(buffer, text_mode_generate_line_runs(start, scanline, screen, font, palette,
+            TEXT_MODE_CELLS_KERNEL));
+        return;
+    }
+#endif
+    // Spacing lines are sent as color runs, which skips the cell kernels altogether.
+    if (screen->line_spacing && !layered) {
+        text_row_line at = text_mode_locate_line(screen, font, text_mode_view_line(screen, font, scanline));
+        if (at.line >= text_mode_row_font(screen, font, at.row)->scan_lines) {
+            text_mode_finish_scanline(buffer, text_mode_generate_spacing_line(start, screen, font, at.row,
+                text_mode_latch_palette()));
+            return;
+        }
+    }
+    uint16_t* line = text_mode_begin_raw_run(start);
+#if TEXT_MODE_LUT_KERNEL
+    uint16_t* write = text_mode_lut_generate_line(line, scanline, screen, font, text_mode_latch_palette());
+#elif TEXT_MODE_ATTR_RUNS
+    uint16_t* write = text_mode_generate_line_attr_runs(line, scanline, screen, font);
+#elif TEXT_MODE_ROW_CACHE
+    uint16_t* write = text_mode_generate_line_cached(line, scanline, screen, font);
+#else
+    uint16_t* write = text_mode_generate_line(line, scanline, screen, font);
+#endif
+    text_mode_cursor_draw(line, cursor, scanline, frame, screen, font, text_mode_latch_palette());
+    text_mode_draw_overlay(line, write, overlay, scanline, font);
+    text_mode_sprite_draw(line, write, sprite, scanline);
+    text_mode_finish_scanline(buffer, text_mode_end_raw_run(start, write));
+}
+
+
+/**
+ * Internal routine: Renders the scan line in a buffer from scanvideo, and the one after it too if they can be
+ * rendered as a pair, and hands them back.
+ * @param block Whether to wait for the second line of a pair, or render the first on its own if it isn't ready
+ * @return Returns the number of scan lines rendered
+ */
+static inline unsigned text_mode_render_next(struct scanvideo_scanline_buffer* buffer, bool block)
+{
+#if TEXT_MODE_RENDER_STATS
+    uint32_t start_time = time_us_32();
+#endif
+    unsigned lines = 1;
+#ifdef TIMING_MEASURE_PIN
+    gpio_put(TIMING_MEASURE_PIN, 1);
+#endif
+    const text_mode_font* font = text_mode_current_font;
+    text_buffer* screen = text_mode_current_buffer;
+    const text_mode_cursor* cursor = text_mode_current_cursor;
+    const text_mode_sprite* sprite = text_mode_current_sprite;
+#if TEXT_MODE_OVERLAY
+    const text_mode_overlay* overlay = text_mode_current_overlay;
+#else
+    const text_mode_overlay* overlay = NULL;
+#endif
+#if TEXT_MODE_PAIRED_LINES && !TEXT_MODE_BLANK_RUNS && !TEXT_MODE_LUT_KERNEL
+    unsigned scanline = scanvideo_scanline_number(buffer->scanline_id);
+    // Only pair up lines that come from the same text row, so they share cells and colors.
+    text_row_line at = text_mode_locate_line(screen, font, text_mode_view_line(screen, font, scanline));
+    struct scanvideo_scanline_buffer* next = NULL;
+    if (at.line + 1u < text_mode_row_font(screen, font, at.row)->scan_lines)
+        next = scanvideo_begin_scanline_generation(block);
+    // scanvideo skips lines that nobody got to in time, and hands lines to whichever core asks first,
+    // so check that this really is the next one.
+    if (next && next->scanline_id == buffer->scanline_id + 1) {
+        uint16_t* start0 = (uint16_t*)buffer->data;
+        uint16_t* start1 = (uint16_t*)next->data;
+        uint16_t* end0 = text_mode_generate_line_pair(text_mode_begin_raw_run(start0),
+            text_mode_begin_raw_run(start1), scanline, screen, font);
+        uint16_t* end1 = start1 + (end0 - start0);
+        unsigned frame = scanvideo_frame_number(buffer->scanline_id);
+        text_mode_cursor_draw(text_mode_begin_raw_run(start0), cursor, scanline, frame, screen, font,
+            text_mode_latch_palette());
+        text_mode_cursor_draw(text_mode_begin_raw_run(start1), cursor, scanline + 1, frame, screen, font,
+            text_mode_latch_palette());
+        text_mode_draw_overlay(text_mode_begin_raw_run(start0), end0, overlay, scanline, font);
+        text_mode_draw_overlay(text_mode_begin_raw_run(start1), end1, overlay, scanline + 1, font);
+        text_mode_sprite_draw(text_mode_begin_raw_run(start0), end0, sprite, scanline);
+        text_mode_sprite_draw(text_mode_begin_raw_run(start1), end1, sprite, scanline + 1);
+        text_mode_finish_scanline(buffer, text_mode_end_raw_run(start0, end0));
+        text_mode_finish_scanline(next, text_mode_end_raw_run(start1, end1));
+        lines = 2;
+    } else {
+        text_mode_render_scanline(buffer, screen, font, cursor, sprite, overlay);
+        if (next) {
+            text_mode_render_scanline(next, screen, font, cursor, sprite, overlay);
+            lines = 2;
+        }
+    }
+#else
+    text_mode_render_scanline(buffer, screen, font, cursor, sprite, overlay);
+#endif
+#ifdef TIMING_MEASURE_PIN
+    gpio_put(TIMING_MEASURE_PIN, 0);
+#endif
+#if TEXT_MODE_RENDER_STATS
+    volatile text_mode_render_stats* stats = &text_mode_core_stats[get_core_num()];
+    stats->lines += lines;
+    stats->busy_us += time_us_32() - start_time;
+#endif
+    return lines;
 }
 
 
@@ -52,55 +551,75 @@ void CORE_1_FUNC(text_mode_render_loop)()
     scanvideo_setup(&TEXT_VIDEO_MODE);
     scanvideo_timing_enable(true);
 #endif
+#if !TEXT_MODE_LUT_KERNEL
     text_mode_setup_interp();
-    while (true) {
-        struct scanvideo_scanline_buffer* buffer = scanvideo_begin_scanline_generation(true);
-#ifdef TIMING_MEASURE_PIN
-        gpio_put(TIMING_MEASURE_PIN, 1);
-#endif
-        uint16_t* write = (uint16_t*)buffer->data;
-        *write++ = COMPOSABLE_RAW_RUN;
-        write++;
-        const text_mode_font* font = text_mode_current_font;
-        text_buffer* screen = text_mode_current_buffer;
-        write = text_mode_generate_line(write, scanvideo_scanline_number(buffer->scanline_id), screen, font);
-        uint16_t* length = (uint16_t*)buffer->data + 1;
-        length[0] = length[1];
-        size_t count = write - length - 1 - 3;
-        length[1] = count;
-        if (count & 1) {
-            *write++ = COMPOSABLE_EOL_SKIP_ALIGN;
-            *write++ = 0;
-        } else {
-            *write++ = COMPOSABLE_EOL_ALIGN;
-        }
-        buffer->data_used = (uint32_t*)write - buffer->data;
-        buffer->status = SCANLINE_OK;
-        scanvideo_end_scanline_generation(buffer);
-#ifdef TIMING_MEASURE_PIN
-        gpio_put(TIMING_MEASURE_PIN, 0);
 #endif
-    }
+    // With another core rendering, the next line may already be its, so don't hold a buffer waiting for it.
+    while (true)
+        text_mode_render_next(scanvideo_begin_scanline_generation(true), !TEXT_MODE_DUAL_CORE);
 }
 
 
+#if TEXT_MODE_DUAL_CORE
+unsigned CORE_1_FUNC(text_mode_render_pending)()
+{
+    unsigned lines = 0;
+    struct scanvideo_scanline_buffer* buffer;
+    while ((buffer = scanvideo_begin_scanline_generation(false)))
+        lines += text_mode_render_next(buffer, false);
+    return lines;
+}
+#endif
+
+
 uint16_t* CORE_1_FUNC(text_mode_generate_line)(uint16_t* write, unsigned scanline, text_buffer* screen, const text_mode_font* font)
 {
-    divmod_result_t r = hw_divider_divmod_u32(scanline, font->scan_lines);
-    uint32_t char_row = to_remainder_u32(r);
-    register int rjump_delta asm("r8") = 4 * (TEXT_MODE_MAX_FONT_WIDTH - font->scan_pixels) + 1; // +1 for Thumb mode
+    text_row_line at = text_mode_locate_line(screen, font, text_mode_view_line(screen, font, scanline));
+    const uint16_t* palette = text_mode_latch_palette();
+    coord_y row = at.row;
+    font = text_mode_row_font(screen, font, row);
+    text_mode_clip clip = text_mode_clip_view_row(screen, font, row);
+    if (at.line >= font->scan_lines)
+        return text_mode_clip_generate_spacing(write, text_buffer_cell(screen, 0, row), &clip, font, palette,
+            text_buffer_row_colors(screen, row));
+    const void* font_row = text_mode_font_row(font, text_mode_glyph_line(screen, font, row, at.line));
+    if (text_buffer_row_size(screen, row))
+        return text_mode_clip_generate_double(write, text_buffer_cell(screen, 0, row), &clip, font_row, font, palette,
+            text_buffer_row_colors(screen, row), text_mode_generate_cells);
+    const text_mode_tiles* tiles = text_mode_row_tiles(screen, row);
+    if (tiles)
+        return text_mode_tile_generate_line(write, text_buffer_cell(screen, 0, row), &clip, tiles, at.line, font,
+            text_buffer_row_colors(screen, row));
+    if (text_mode_bitmap_on_row(screen, row))
+        return text_mode_bitmap_generate_cells(write, screen, row, at.line, &clip, font_row, font, palette,
+            text_buffer_row_colors(screen, row), text_mode_generate_cells);
+    return text_mode_clip_generate_cells(write, text_buffer_cell(screen, 0, row), &clip, font_row, font, palette,
+        text_buffer_row_colors(screen, row), text_mode_generate_cells);
+}
+
+
+/**
+ * Internal routine: text_mode_generate_cells() for fonts whose glyph rows are read with glyph_bytes bytes,
+ * which must be a constant.
+ */
+static inline __attribute__((always_inline)) uint16_t* text_mode_generate_cells_storage(const unsigned glyph_bytes,
+    uint16_t* write, const text_cell* cells, unsigned count, const void* font_row, const text_mode_font* font,
+    const uint16_t* palette, color_pair colors)
+{
+    register int rjump_delta asm("r8") = text_mode_loop_entry(font);
     register int rwrite_inc asm("r9") = font->scan_pixels * 2;
-    register unsigned int embiggenationator asm("r10") = 0x1 << (SHIFT_AMOUNT - 1);
+    register unsigned int embiggenationator asm("r10") = TEXT_MODE_EMBIGGENER;
     register uint32_t rbytes asm("r1") = font->bytes_per_glyph;
-    register text_cell* rread asm("r2") = text_buffer_cell(screen, 0, to_quotient_u32(r));
-    register TEXT_MODE_FONT_DATA_TYPE* rfont asm("r3") = (TEXT_MODE_FONT_DATA_TYPE*)font->data + char_row;
-    register uint32_t rcols asm("r4") = screen->size.x;
+    register const text_cell* rread asm("r2") = cells;
+    register const void* rfont asm("r3") = font_row;
+    register uint32_t rcols asm("r4") = count;
+    assert(sizeof(text_cell) == CELL_SIZE);
 #if !TEXT_MODE_PALETTIZED_COLOR
-    assert(sizeof(text_cell) == 6);
+    (void)palette;
 #else
-    register uint16_t* rpalette asm("r6") = text_mode_current_palette;
-    assert(sizeof(text_cell) == 4);
+    register const uint16_t* rpalette asm("r6") = palette;
 #endif
+    text_mode_load_colors(colors, palette);
     asm volatile(
         // This uses the RP2040's interpolator's CLAMP mode to produce one of two possible values
         // for each input bit of the glyph's bitmap.
@@ -129,28 +648,13 @@ uint16_t* CORE_1_FUNC(text_mode_generate_line)(uint16_t* write, unsigned scanlin
         // r8: loop entry address
         // r9: write increment
         // r10: 0x00010000 (makes forground color bigger for interpolator clamp mode)
-        "cellchar = 0\n"
-        "cellfg = 2\n"
-#if !TEXT_MODE_PALETTIZED_COLOR
-        "cellbg = 4\n"
-        "cellsize = 6\n"
-#else
-        "cellbg = 3\n"
-        "cellsize = 4\n"
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH <= 15
-        "shiftamount = 17\n"
-#else
-        "shiftamount = 17 - (TEXT_MODE_MAX_FONT_WIDTH - 15)"
-#endif
-        "accum0 = 0\n"
-        "accum1 = 4\n"
-        "base0 = 8\n"
-        "base1 = 12\n"
-        "pop0 = 20\n"
+        CELL_SYMBOLS
+        SHIFT_AMOUNT_SYMBOL
+        INTERP_SYMBOLS
         "// Cache loop start address\n"
         "    adr     r7, loop_entry%=\n"
         "    add     %[loopstart], r7\n"
+#if !TEXT_MODE_GLYPH_ONLY_CELLS
         "// Fetch colors\n"
 #if !TEXT_MODE_PALETTIZED_COLOR
         "    ldrh    r7, [%[read], #cellfg]\n"
@@ -169,19 +673,15 @@ uint16_t* CORE_1_FUNC(text_mode_generate_line)(uint16_t* write, unsigned scanlin
         "    ldrh    r7, [%[palette], r7]\n"
 #endif
         "    str     r7, [%[interp], #base0]\n"
+#endif
         "// Fetch character\n"
         "    ldrh    r7, [%[read], #cellchar]\n"
         "    add     %[read], %[read], #cellsize\n"
         "    // RP2040's CPU cores have the single-cycle multiplier option so shifting isn't any faster\n"
         "    // and is really only useful if you need to save a register.\n"
+        "    // For scan-line-major fonts, glyphsize is just the size of one scan line.\n"
         "    mul     r7, %[glyphsize], r7\n"
-#if TEXT_MODE_MAX_FONT_WIDTH <= 8
-        "    ldrb    r7, [%[font], r7]\n"
-#elif TEXT_MODE_MAX_FONT_WIDTH <= 16
-        "    ldrh    r7, [%[font], r7]\n"
-#else
-        "    ldr     r7, [%[font], r7]\n"
-#endif
+        LOAD_GLYPH_ROW
         "    lsl     r7, r7, #shiftamount\n"
         "    str     r7, [%[interp], #accum0]\n"
         "    str     r7, [%[interp], #accum1]\n"
@@ -189,102 +689,11 @@ uint16_t* CORE_1_FUNC(text_mode_generate_line)(uint16_t* write, unsigned scanlin
         "    bx      %[loopstart]\n"
         ".balign 4 // ADR requires 32-bit alignment\n"
         "loop_entry%=:"
-#define handlebit(bit) "    ldr     r7, [%[interp], #pop0]\n" \
-"    strh    r7, [%[write], #(" #bit " * 2)]\n"
-#if TEXT_MODE_MAX_FONT_WIDTH > 29
-        handlebit(29)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 28
-        handlebit(28)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 27
-        handlebit(27)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 26
-        handlebit(26)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 25
-        handlebit(25)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 24
-        handlebit(24)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 23
-        handlebit(23)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 22
-        handlebit(22)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 21
-        handlebit(21)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 20
-        handlebit(20)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 19
-        handlebit(19)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 18
-        handlebit(18)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 17
-        handlebit(17)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 16
-        handlebit(16)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 15
-        handlebit(15)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 14
-        handlebit(14)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 13
-        handlebit(13)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 12
-        handlebit(12)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 11
-        handlebit(11)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 10
-        handlebit(10)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 9
-        handlebit(9)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 8
-        handlebit(8)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 7
-        handlebit(7)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 6
-        handlebit(6)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 5
-        handlebit(5)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 4
-        handlebit(4)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 3
-        handlebit(3)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 2
-        handlebit(2)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH > 1
-        handlebit(1)
-#endif
-#if TEXT_MODE_MAX_FONT_WIDTH < 1
-#error "TEXT_MODE_MAX_FONT_WIDTH is less than one???"
-#endif
-        handlebit(0)
+        UNROLLED_BITS(handlebit)
         "    add     %[write], %[writeinc]\n"
         "    sub     %[cols], #1\n"
         "    beq     done%=\n"
+#if !TEXT_MODE_GLYPH_ONLY_CELLS
         "// Fetch colors\n"
 #if !TEXT_MODE_PALETTIZED_COLOR
         "    ldrh    r7, [%[read], #cellfg]\n"
@@ -303,17 +712,12 @@ uint16_t* CORE_1_FUNC(text_mode_generate_line)(uint16_t* write, unsigned scanlin
         "    ldrh    r7, [%[palette], r7]\n"
 #endif
         "    str     r7, [%[interp], #base0]\n"
+#endif
         "// Fetch character\n"
         "    ldrh    r7, [%[read], #cellchar]\n"
         "    add     %[read], %[read], #cellsize\n"
         "    mul     r7, %[glyphsize], r7\n"
-#if TEXT_MODE_MAX_FONT_WIDTH <= 8
-        "    ldrb    r7, [%[font], r7]\n"
-#elif TEXT_MODE_MAX_FONT_WIDTH <= 16
-        "    ldrh    r7, [%[font], r7]\n"
-#else
-        "    ldr     r7, [%[font], r7]\n"
-#endif
+        LOAD_GLYPH_ROW
         "    lsl     r7, r7, #shiftamount\n"
         "    str     r7, [%[interp], #accum0]\n"
         "    str     r7, [%[interp], #accum1]\n"
@@ -328,17 +732,428 @@ uint16_t* CORE_1_FUNC(text_mode_generate_line)(uint16_t* write, unsigned scanlin
        "[read]"         (rread),
         [font]     "r"  (rfont),
        "[cols]"    "r"  (rcols),
-        [interp]   "r"  (interp1_hw),
+        [interp]   "r"  (TEXT_MODE_DECODE_INTERP),
 #if TEXT_MODE_PALETTIZED_COLOR
         [palette]  "r"  (rpalette),
 #endif
        "[loopstart]""r" (rjump_delta),
         [writeinc] "r"  (rwrite_inc),
-        [embiggener]"r" (embiggenationator)
+        [embiggener]"r" (embiggenationator),
+        [glyphbytes]"i" (glyph_bytes)
      : "cc", "memory", "r7"
     );
-#undef resetbit
-#undef sethighbit
-#undef setbit
     return write;
 }
+
+
+uint16_t* CORE_1_FUNC(text_mode_generate_cells)(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors)
+{
+    return GLYPH_BYTES_DISPATCH(font, text_mode_generate_cells_storage, write, cells, count, font_row, font, palette,
+        colors);
+}
+
+
+#if TEXT_MODE_PAIRED_LINES
+uint16_t* CORE_1_FUNC(text_mode_generate_line_pair)(uint16_t* write0, uint16_t* write1, unsigned scanline,
+    text_buffer* screen, const text_mode_font* font)
+{
+    text_row_line at = text_mode_locate_line(screen, font, text_mode_view_line(screen, font, scanline));
+    const uint16_t* palette = text_mode_latch_palette();
+    coord_y row = at.row;
+    // Double size rows don't show consecutive glyph lines side by side, so their lines are done one at a time,
+    // and so are tile rows and rows with bitmap regions.
+    if (text_buffer_row_size(screen, row) || text_mode_row_tiles(screen, row) || text_mode_bitmap_on_row(screen, row)) {
+        text_mode_generate_line(write1, scanline + 1, screen, font);
+        return text_mode_generate_line(write0, scanline, screen, font);
+    }
+    font = text_mode_row_font(screen, font, row);
+    text_mode_clip clip = text_mode_clip_view(screen, font);
+    return text_mode_clip_generate_cells_pair(write0, write1, text_buffer_cell(screen, 0, row), &clip,
+        text_mode_font_row(font, at.line), font, palette, text_buffer_row_colors(screen, row),
+        text_mode_generate_cells_pair);
+}
+
+
+/**
+ * Internal routine: text_mode_generate_cells_pair() for fonts whose glyph rows are read with glyph_bytes bytes,
+ * which must be a constant.
+ */
+static inline __attribute__((always_inline)) uint16_t* text_mode_generate_cells_pair_storage(
+    const unsigned glyph_bytes, uint16_t* write0, uint16_t* write1, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors)
+{
+    register uint16_t* rwrite0 asm("r0") = write0;
+    register uint32_t rbytes asm("r1") = font->bytes_per_glyph;
+    register const text_cell* rread asm("r2") = cells;
+    register uint16_t* rwrite1 asm("r3") = write1;
+    register interp_hw_t* rinterp asm("r5") = TEXT_MODE_DECODE_INTERP;
+    register uint32_t rcols asm("r6") = count;
+    register int rjump_delta asm("r8") = text_mode_loop_entry(font);
+    register int rwrite_inc asm("r9") = font->scan_pixels * 2;
+    register unsigned int embiggenationator asm("r10") = TEXT_MODE_EMBIGGENER;
+    register const void* rfont asm("r11") = font_row;
+    register uint32_t rstride asm("r12") = font->scan_line_stride;
+    assert(sizeof(text_cell) == CELL_SIZE);
+#if !TEXT_MODE_PALETTIZED_COLOR
+    (void)palette;
+#else
+    // This starts out in r4 only because there's no other register free to pass it in.
+    register const uint16_t* rpalette asm("r4") = palette;
+#endif
+    text_mode_load_colors(colors, palette);
+    asm volatile(
+        // Same decoding as text_mode_generate_cells(), but for two consecutive scan lines of the same text row.
+        // The cell, its colors, and its glyph are fetched once and BASE0 and BASE1 are left alone, so only
+        // the accumulators need reloading between the two lines.
+        // There's only one interpolator with clamp mode, so the lines are decoded one after the other,
+        // each with its own copy of the unrolled loop.
+        // Register allocations:
+        // r0: write pointer for the first line
+        // r1: bytes per glyph
+        // r2: read pointer
+        // r3: write pointer for the second line
+        // r4: second line's glyph bits (palette pointer on entry when applicable)
+        // r5: interpolator pointer
+        // r6: column counter
+        // r7: temp
+        // r8: loop entry address
+        // r9: write increment
+        // r10: 0x00010000 (makes forground color bigger for interpolator clamp mode)
+        // r11: font pointer for the first line
+        // r12: font stride from the first line to the second
+        // lr: palette pointer when applicable
+        CELL_SYMBOLS
+        SHIFT_AMOUNT_SYMBOL
+        INTERP_SYMBOLS
+        "// Cache loop start address\n"
+        "    adr     r7, pair_entry0%=\n"
+        "    add     %[loopstart], r7\n"
+#if TEXT_MODE_PALETTIZED_COLOR
+        "    mov     lr, %[palette]\n"
+#endif
+        "    b       pair_fetch%=\n"
+        ".balign 4 // ADR requires 32-bit alignment\n"
+        "pair_entry0%=:"
+        UNROLLED_BITS(handlebit)
+        "// Second line\n"
+#if TEXT_MODE_SPLIT_DECODE
+        SPLIT_ROW("r4")
+        "    lsl     r4, r4, #shiftamount\n"
+#endif
+        "    str     r4, [%[interp], #accum0]\n"
+        "    str     r4, [%[interp], #accum1]\n"
+        "    mov     r7, %[loopstart]\n"
+        "    add     r7, #(pair_entry1%= - pair_entry0%=)\n"
+        "    bx      r7\n"
+        "pair_entry1%=:"
+        UNROLLED_BITS(handlebit_write1)
+        "    add     %[write], %[writeinc]\n"
+        "    add     %[write1], %[writeinc]\n"
+        "    sub     %[cols], #1\n"
+        "    beq     pair_done%=\n"
+        "pair_fetch%=:\n"
+#if !TEXT_MODE_GLYPH_ONLY_CELLS
+        "// Fetch colors\n"
+#if !TEXT_MODE_PALETTIZED_COLOR
+        "    ldrh    r7, [%[read], #cellfg]\n"
+#else
+        "    ldrb    r7, [%[read], #cellfg]\n"
+        "    lsl     r7, r7, #1\n"
+        "    add     r7, lr\n"
+        "    ldrh    r7, [r7]\n"
+#endif
+        "    add     r7, %[embiggener]\n"
+        "    str     r7, [%[interp], #base1]\n"
+#if !TEXT_MODE_PALETTIZED_COLOR
+        "    ldrh    r7, [%[read], #cellbg]\n"
+#else
+        "    ldrb    r7, [%[read], #cellbg]\n"
+        "    lsl     r7, r7, #1\n"
+        "    add     r7, lr\n"
+        "    ldrh    r7, [r7]\n"
+#endif
+        "    str     r7, [%[interp], #base0]\n"
+#endif
+        "// Fetch character\n"
+        "    ldrh    r7, [%[read], #cellchar]\n"
+        "    add     %[read], %[read], #cellsize\n"
+        "    mul     r7, %[glyphsize], r7\n"
+        "    add     r7, %[font]\n"
+        "    mov     r4, r7\n"
+        "    add     r4, %[stride]\n"
+        GLYPH_LOAD("r7", "[r7]")
+        SPLIT_ROW("r7")
+        "    lsl     r7, r7, #shiftamount\n"
+        "    str     r7, [%[interp], #accum0]\n"
+        "    str     r7, [%[interp], #accum1]\n"
+        GLYPH_LOAD("r4", "[r4]")
+#if !TEXT_MODE_SPLIT_DECODE
+        // With split decode, this waits until the second line, since INTERP0 needs the raw bits then.
+        "    lsl     r4, r4, #shiftamount\n"
+#endif
+        "    bx      %[loopstart]\n"
+        "pair_done%=:"
+     :  [read]     "+r" (rread),
+        [write]    "+r" (rwrite0),
+        [write1]   "+r" (rwrite1),
+        [cols]     "+r" (rcols),
+#if TEXT_MODE_PALETTIZED_COLOR
+        [palette]  "+r" (rpalette),
+#endif
+        [loopstart]"+r" (rjump_delta)
+     :  [glyphsize]"r"  (rbytes),
+        [font]     "r"  (rfont),
+        [stride]   "r"  (rstride),
+        [interp]   "r"  (rinterp),
+        [writeinc] "r"  (rwrite_inc),
+        [embiggener]"r" (embiggenationator),
+        [glyphbytes]"i" (glyph_bytes)
+     : "cc", "memory", "r7"
+#if !TEXT_MODE_PALETTIZED_COLOR
+        , "r4"
+#else
+        , "lr"
+#endif
+    );
+    return rwrite0;
+}
+
+
+uint16_t* CORE_1_FUNC(text_mode_generate_cells_pair)(uint16_t* write0, uint16_t* write1, const text_cell* cells,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors)
+{
+    return GLYPH_BYTES_DISPATCH(font, text_mode_generate_cells_pair_storage, write0, write1, cells, count, font_row,
+        font, palette, colors);
+}
+#endif
+
+
+#if TEXT_MODE_ROW_CACHE
+/**
+ * Row cache for the render core.
+ * Scratch X keeps the render core's per-cell reads off the banks core 0 writes the text buffer in.
+ * It shares that bank with core 1's stack; see TEXT_MODE_SCRATCH_X_BUDGET.
+ */
+static text_mode_row_cache __scratch_x("text_mode_row_cache") text_mode_render_row_cache = { .row = -1 };
+
+
+/**
+ * Internal routine: Renders the cells in the render core's row cache, for fonts whose glyph rows are read with
+ * glyph_bytes bytes, which must be a constant.
+ */
+static inline __attribute__((always_inline)) uint16_t* text_mode_generate_cached_cells(const unsigned glyph_bytes,
+    uint16_t* write, const void* font_row, const text_mode_font* font)
+{
+    register int rjump_delta asm("r8") = text_mode_loop_entry(font);
+    register int rwrite_inc asm("r9") = font->scan_pixels * 2;
+    register text_mode_cached_cell* rread asm("r2") = text_mode_render_row_cache.cells;
+    register const void* rfont asm("r3") = font_row;
+    register uint32_t rcols asm("r4") = text_mode_render_row_cache.cols;
+    register interp_hw_t* rinterp asm("r5") = TEXT_MODE_DECODE_INTERP;
+    assert(sizeof(text_mode_cached_cell) == 12);
+    asm volatile(
+        // Same decoding as text_mode_generate_line(), but each cell has already been resolved into
+        // the BASE1 and BASE0 values and the glyph's byte offset, which a single ldmia fetches.
+        // Register allocations:
+        // r0: write pointer
+        // r1: temp (BASE1 value)
+        // r2: read pointer into the row cache
+        // r3: font pointer
+        // r4: column counter
+        // r5: interpolator pointer
+        // r6: temp (BASE0 value)
+        // r7: temp (glyph offset, then glyph bits)
+        // r8: loop entry address
+        // r9: write increment
+        SHIFT_AMOUNT_SYMBOL
+        INTERP_SYMBOLS
+        "// Cache loop start address\n"
+        "    adr     r7, cached_loop_entry%=\n"
+        "    add     %[loopstart], r7\n"
+        "// Fetch cell\n"
+        "    ldmia   %[read]!, {r1, r6, r7}\n"
+        "    str     r1, [%[interp], #base1]\n"
+        "    str     r6, [%[interp], #base0]\n"
+        LOAD_GLYPH_ROW
+        "    lsl     r7, r7, #shiftamount\n"
+        "    str     r7, [%[interp], #accum0]\n"
+        "    str     r7, [%[interp], #accum1]\n"
+        "// Unrolled loop\n"
+        "    bx      %[loopstart]\n"
+        ".balign 4 // ADR requires 32-bit alignment\n"
+        "cached_loop_entry%=:"
+        UNROLLED_BITS(handlebit)
+        "    add     %[write], %[writeinc]\n"
+        "    sub     %[cols], #1\n"
+        "    beq     cached_done%=\n"
+        "// Fetch cell\n"
+        "    ldmia   %[read]!, {r1, r6, r7}\n"
+        "    str     r1, [%[interp], #base1]\n"
+        "    str     r6, [%[interp], #base0]\n"
+        LOAD_GLYPH_ROW
+        "    lsl     r7, r7, #shiftamount\n"
+        "    str     r7, [%[interp], #accum0]\n"
+        "    str     r7, [%[interp], #accum1]\n"
+        "    bx      %[loopstart]\n"
+        "cached_done%=:"
+     :  [read]     "=r" (rread),
+        [write]    "=r" (write),
+        [cols]     "=r" (rcols),
+        [loopstart]"=r" (rjump_delta)
+     : "[write]"        (write),
+       "[read]"         (rread),
+        [font]     "r"  (rfont),
+       "[cols]"         (rcols),
+        [interp]   "r"  (rinterp),
+       "[loopstart]"    (rjump_delta),
+        [writeinc] "r"  (rwrite_inc),
+        [glyphbytes]"i" (glyph_bytes)
+     : "cc", "memory", "r1", "r6", "r7"
+    );
+    return write;
+}
+
+
+uint16_t* CORE_1_FUNC(text_mode_generate_line_cached)(uint16_t* write, unsigned scanline, text_buffer* screen, const text_mode_font* font)
+{
+    text_row_line at = text_mode_locate_line(screen, font, text_mode_view_line(screen, font, scanline));
+    const uint16_t* palette = text_mode_latch_palette();
+    coord_y row = at.row;
+    const text_mode_font* row_font = text_mode_row_font(screen, font, row);
+    text_mode_clip clip = text_mode_clip_view(screen, row_font);
+    // Spacing lines don't use any glyphs, double size rows need their pixels doubled, and tiles and bitmap regions
+    // aren't glyphs, so they go the simple way.
+    if (at.line >= row_font->scan_lines || text_buffer_row_size(screen, row) || text_mode_row_tiles(screen, row)
+        || text_mode_bitmap_on_row(screen, row)
+        || !text_mode_row_cache_update(&text_mode_render_row_cache, screen, scanline, row, clip.col, clip.cols,
+            row_font, palette))
+        return text_mode_generate_line(write, scanline, screen, font);
+    font = row_font;
+    const void* font_row = text_mode_font_row(font, at.line);
+    // Cells cut off by the view aren't cached, so they come straight from the buffer.
+    const text_cell* cells = text_buffer_cell(screen, clip.col, row);
+    color_pair colors = text_buffer_row_colors(screen, row);
+    if (clip.head)
+        write = text_mode_clip_generate_cell(write, cells - 1, clip.skip, clip.head, font_row, font, palette, colors,
+            text_mode_generate_cells);
+    write = GLYPH_BYTES_DISPATCH(font, text_mode_generate_cached_cells, write, font_row, font);
+    if (clip.tail)
+        write = text_mode_clip_generate_cell(write, cells + clip.cols, 0, clip.tail, font_row, font, palette, colors,
+            text_mode_generate_cells);
+    return write;
+}
+#endif
+
+
+#if TEXT_MODE_ATTR_RUNS
+/**
+ * Attribute runs for the render core.
+ * Scratch X keeps the render core's reads off the banks core 0 writes the text buffer in.
+ * It shares that bank with core 1's stack; see TEXT_MODE_SCRATCH_X_BUDGET.
+ */
+static text_mode_attr_row __scratch_x("text_mode_attr_row") text_mode_render_attr_row = { .row = -1 };
+
+
+/**
+ * Internal routine: Renders the cells in the render core's attribute runs, for fonts whose glyph rows are read with
+ * glyph_bytes bytes, which must be a constant.
+ */
+static inline __attribute__((always_inline)) uint16_t* text_mode_generate_attr_cells(const unsigned glyph_bytes,
+    uint16_t* write, const void* font_row, const text_mode_font* font)
+{
+    register uint16_t* rwrite asm("r0") = write;
+    register text_mode_attr_run* rruns asm("r2") = text_mode_render_attr_row.runs;
+    register const void* rfont asm("r3") = font_row;
+    register interp_hw_t* rinterp asm("r5") = TEXT_MODE_DECODE_INTERP;
+    register uint32_t* rglyphs asm("r6") = text_mode_render_attr_row.glyph_offsets;
+    register int rjump_delta asm("r8") = text_mode_loop_entry(font);
+    register int rwrite_inc asm("r9") = font->scan_pixels * 2;
+    register text_mode_attr_run* rruns_end asm("r10") = text_mode_render_attr_row.runs + text_mode_render_attr_row.run_count;
+    assert(sizeof(text_mode_attr_run) == 12);
+    asm volatile(
+        // Same decoding as text_mode_generate_line(), but BASE0 and BASE1 are only written at the start
+        // of each run of cells with the same colors; within a run, each cell is just a glyph offset.
+        // Register allocations:
+        // r0: write pointer
+        // r1: cells left in the current run
+        // r2: read pointer into the runs
+        // r3: font pointer
+        // r4: temp (BASE1 value)
+        // r5: interpolator pointer
+        // r6: read pointer into the glyph offsets
+        // r7: temp (BASE0 value, then glyph offset, then glyph bits)
+        // r8: loop entry address
+        // r9: write increment
+        // r10: end of the runs
+        SHIFT_AMOUNT_SYMBOL
+        INTERP_SYMBOLS
+        "// Cache loop start address\n"
+        "    adr     r7, attr_loop_entry%=\n"
+        "    add     %[loopstart], r7\n"
+        "attr_run%=:\n"
+        "// Fetch run\n"
+        "    ldmia   %[runs]!, {r1, r4, r7}\n"
+        "    str     r4, [%[interp], #base1]\n"
+        "    str     r7, [%[interp], #base0]\n"
+        "attr_cell%=:\n"
+        "// Fetch glyph\n"
+        "    ldmia   %[glyphs]!, {r7}\n"
+        LOAD_GLYPH_ROW
+        "    lsl     r7, r7, #shiftamount\n"
+        "    str     r7, [%[interp], #accum0]\n"
+        "    str     r7, [%[interp], #accum1]\n"
+        "// Unrolled loop\n"
+        "    bx      %[loopstart]\n"
+        ".balign 4 // ADR requires 32-bit alignment\n"
+        "attr_loop_entry%=:"
+        UNROLLED_BITS(handlebit)
+        "    add     %[write], %[writeinc]\n"
+        "    sub     r1, #1\n"
+        "    bne     attr_cell%=\n"
+        "    cmp     %[runs], %[runsend]\n"
+        "    bne     attr_run%=\n"
+     :  [runs]     "+r" (rruns),
+        [glyphs]   "+r" (rglyphs),
+        [write]    "+r" (rwrite),
+        [loopstart]"+r" (rjump_delta)
+     :  [font]     "r"  (rfont),
+        [interp]   "r"  (rinterp),
+        [writeinc] "r"  (rwrite_inc),
+        [runsend]  "r"  (rruns_end),
+        [glyphbytes]"i" (glyph_bytes)
+     : "cc", "memory", "r1", "r4", "r7"
+    );
+    return rwrite;
+}
+
+
+uint16_t* CORE_1_FUNC(text_mode_generate_line_attr_runs)(uint16_t* write, unsigned scanline, text_buffer* screen, const text_mode_font* font)
+{
+    text_row_line at = text_mode_locate_line(screen, font, text_mode_view_line(screen, font, scanline));
+    const uint16_t* palette = text_mode_latch_palette();
+    coord_y row = at.row;
+    const text_mode_font* row_font = text_mode_row_font(screen, font, row);
+    text_mode_clip clip = text_mode_clip_view(screen, row_font);
+    // Spacing lines don't use any glyphs, double size rows need their pixels doubled, and tiles and bitmap regions
+    // aren't glyphs, so they go the simple way.
+    if (at.line >= row_font->scan_lines || text_buffer_row_size(screen, row) || text_mode_row_tiles(screen, row)
+        || text_mode_bitmap_on_row(screen, row)
+        || !text_mode_attr_row_update(&text_mode_render_attr_row, screen, scanline, row, clip.col, clip.cols,
+            row_font, palette))
+        return text_mode_generate_line(write, scanline, screen, font);
+    font = row_font;
+    const void* font_row = text_mode_font_row(font, at.line);
+    // Cells cut off by the view aren't held, so they come straight from the buffer.
+    const text_cell* cells = text_buffer_cell(screen, clip.col, row);
+    color_pair colors = text_buffer_row_colors(screen, row);
+    if (clip.head)
+        write = text_mode_clip_generate_cell(write, cells - 1, clip.skip, clip.head, font_row, font, palette, colors,
+            text_mode_generate_cells);
+    write = GLYPH_BYTES_DISPATCH(font, text_mode_generate_attr_cells, write, font_row, font);
+    if (clip.tail)
+        write = text_mode_clip_generate_cell(write, cells + clip.cols, 0, clip.tail, font_row, font, palette, colors,
+            text_mode_generate_cells);
+    return write;
+}
+#endif
@@ -5,6 +5,9 @@
 #include "text_buffer.h"
 #include "text_window.h"
 #include "text_mode_font.h"
+#include "text_mode_cursor.h"
+#include "text_mode_sprite.h"
+#include "text_mode_overlay.h"
 
 /**
  * Pointer to currently active page of text to display.
@@ -30,13 +33,101 @@ extern const text_mode_font* volatile text_mode_current_font;
 extern uint16_t* volatile text_mode_current_palette;
 #endif
 
+/**
+ * Pointer to the cursor to draw over the text, or NULL for none.
+ * This is latched once per line and can be changed on-demand without any special synchronization;
+ * the cursor it points to can be moved the same way.
+ */
+extern const text_mode_cursor* volatile text_mode_current_cursor;
+
+/**
+ * Pointer to the sprite to draw over the screen, such as a mouse pointer, or NULL for none.
+ * This is latched once per line and can be changed on-demand without any special synchronization;
+ * the sprite it points to can be moved the same way.
+ */
+extern const text_mode_sprite* volatile text_mode_current_sprite;
+
+#if TEXT_MODE_OVERLAY
+/**
+ * Pointer to a text layer to draw over the main buffer, under the sprite, or NULL for none.
+ * This is latched once per line and can be changed on-demand without any special synchronization.
+ */
+extern const text_mode_overlay* volatile text_mode_current_overlay;
+#endif
+
+#if TEXT_MODE_FONT_POOL_SIZE
+/**
+ * Copies a font into a pool of TEXT_MODE_FONT_POOL_SIZE bytes in scratch X, so the render core's glyph reads
+ * can't be slowed down by core 0 hammering main RAM. This doesn't switch to the copy; set text_mode_current_font
+ * or a row font to it once the text it draws stays within its glyphs.
+ * Scratch X is only 4 KB, and core 1's stack (PICO_CORE1_STACK_SIZE, 2 KB by default), the row cache, and
+ * the attribute runs live there too, so TEXT_MODE_FONT_POOL_SIZE can be at most what they leave over,
+ * which text_mode.c checks when it's built.
+ * Most fonts only fit cut down to the glyphs the text actually uses (see text_mode_font_relocate());
+ * for example, ASCII in an 8×12 font is 1.5 KB.
+ * The renderer doesn't check glyphs against the copy's glyph_count, so a cell with a glyph past the ones copied
+ * reads whatever follows in scratch X, which may be core 1's stack, and draws garbage.
+ * The copy points at the source's blank scan line metadata, which stays in main RAM rather than taking pool space;
+ * it still covers the copied glyphs, since they're the first ones.
+ * The copy can also be used as a row font. To put a font in another bank, such as one of the non-striped banks
+ * reserved by a custom linker script, copy it there with text_mode_font_relocate() and switch to it yourself.
+ * @param font Font to copy
+ * @param glyph_count Number of glyphs to copy from the start of the font, or 0 for all of them
+ * @return Returns the copy, or NULL if it doesn't fit in what's left of the pool
+ */
+const text_mode_font* text_mode_pin_font(const text_mode_font* font, unsigned glyph_count);
+
+/**
+ * Empties the pool text_mode_pin_font() copies fonts into.
+ * Switch away from every pinned font first, including row fonts, since the next one pinned overwrites them.
+ */
+void text_mode_unpin_fonts(void);
+#endif
+
 /**
  * Launch this on core 1 to start rendering textual video.
+ * With TEXT_MODE_DUAL_CORE, core 0 can run this too, or call text_mode_render_pending() whenever it's idle.
  */
 void text_mode_render_loop(void);
 
+#if TEXT_MODE_DUAL_CORE
+/**
+ * Renders every scan line scanvideo is ready to have rendered and returns without waiting for more,
+ * so core 0 can share the rendering with core 1 between its own work.
+ * scanvideo hands each line to whichever core asks for it first and sends them out in order,
+ * so this can be called as often or as rarely as is convenient.
+ * @note Call text_mode_setup_interp() on core 0 first, unless TEXT_MODE_LUT_KERNEL is set.
+ * @return Returns the number of scan lines rendered
+ */
+unsigned text_mode_render_pending(void);
+#endif
+
+#if TEXT_MODE_RENDER_STATS
+/**
+ * Running totals of how much rendering one core has done.
+ * These only ever count up, and wrap around, so take the difference between two readings.
+ */
+typedef struct text_mode_render_stats
+{
+    /** Scan lines rendered. */
+    uint32_t lines;
+    /** Microseconds spent rendering them, from getting the line from scanvideo to handing it back. */
+    uint32_t busy_us;
+} text_mode_render_stats;
+
+/**
+ * Rendering totals for each core, indexed by get_core_num().
+ */
+extern volatile text_mode_render_stats text_mode_core_stats[NUM_CORES];
+#endif
+
 /**
  * This is the line generator routine for text mode.
+ * Only the part of the line in the buffer's view is rendered.
+ * Spacing lines (see text_buffer.line_spacing) are rendered as plain background pixels;
+ * the render loop sends them as color runs with text_mode_generate_spacing_line() instead.
+ * Double size rows (see text_row_size) are rendered by text_mode_clip_generate_double().
+ * Rows with a font of their own (see text_buffer.row_fonts) are rendered in that.
  * @note Call text_mode_setup_interp() on each core that uses this routine.
  * @param write Write pointer
  * @param scanline Scanline number from scanvideo_scanline_number(buffer->scanline_id)
@@ -46,6 +137,79 @@ void text_mode_render_loop(void);
  */
 uint16_t* text_mode_generate_line(uint16_t* write, unsigned scanline, text_buffer* screen, const text_mode_font* font);
 
+#if TEXT_MODE_ROW_CACHE
+/**
+ * Same as text_mode_generate_line(), but resolves each text row into a row cache in scratch X
+ * at its first scan line, and renders the row's other scan lines from the cache.
+ * Changes to the text buffer or palette entries show up at the next text row, or the next frame if that's the same
+ * row, instead of the next scan line.
+ * Falls back to text_mode_generate_line() if the buffer is wider than TEXT_MODE_ROW_CACHE_MAX_COLS.
+ * @note Only one core may use this routine, because there is only one cache.
+ */
+uint16_t* text_mode_generate_line_cached(uint16_t* write, unsigned scanline, text_buffer* screen, const text_mode_font* font);
+#endif
+
+#if TEXT_MODE_ATTR_RUNS
+/**
+ * Same as text_mode_generate_line(), but splits each text row into runs of cells with the same colors
+ * at its first scan line, and only loads the interpolator's colors once per run.
+ * Changes to the text buffer or palette entries show up at the next text row, or the next frame if that's the same
+ * row, instead of the next scan line.
+ * Falls back to text_mode_generate_line() if the buffer is wider than TEXT_MODE_ATTR_RUNS_MAX_COLS.
+ * @note Only one core may use this routine, because there is only one copy of the runs.
+ */
+uint16_t* text_mode_generate_line_attr_runs(uint16_t* write, unsigned scanline, text_buffer* screen, const text_mode_font* font);
+#endif
+
+/**
+ * Renders one scan line of a span of cells.
+ * This is the inner part of text_mode_generate_line(), for callers that build scan lines piece by piece.
+ * @note Call text_mode_setup_interp() on each core that uses this routine.
+ * @param write Write pointer
+ * @param cells First cell to render
+ * @param count Number of cells to render, which must not be zero
+ * @param font_row Scan line of glyph 0 to render, from text_mode_font_row()
+ * @param font Pointer to font to use for rendering
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @param colors Colors of every cell, from text_buffer_row_colors(); ignored unless TEXT_MODE_GLYPH_ONLY_CELLS is set
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_generate_cells(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors);
+
+#if TEXT_MODE_PAIRED_LINES
+/**
+ * Renders two consecutive scan lines of the same text row in one pass over the cells,
+ * so the per-cell fetches and color lookups are only paid once for both lines.
+ * Double size rows fall back to rendering each line with text_mode_generate_line().
+ * @note Call text_mode_setup_interp() on each core that uses this routine.
+ * @param write0 Write pointer for the first line
+ * @param write1 Write pointer for the second line, which advances exactly as far as write0 does
+ * @param scanline Scanline number of the first line, which must not show the last glyph line of a text row
+ *        or a spacing line once the buffer's view is applied (see text_mode_view_line())
+ * @param screen Pointer to text_buffer with page of text to display
+ * @param font Pointer to font to use for rendering
+ * @return Returns modified write0
+ */
+uint16_t* text_mode_generate_line_pair(uint16_t* write0, uint16_t* write1, unsigned scanline,
+    text_buffer* screen, const text_mode_font* font);
+
+/**
+ * Two-line version of text_mode_generate_cells().
+ * @param write0 Write pointer for the first line
+ * @param write1 Write pointer for the second line
+ * @param cells First cell to render
+ * @param count Number of cells to render, which must not be zero
+ * @param font_row Scan line of glyph 0 to render on the first line; the second line uses the next one
+ * @param font Pointer to font to use for rendering
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @param colors Colors of every cell, from text_buffer_row_colors(); ignored unless TEXT_MODE_GLYPH_ONLY_CELLS is set
+ * @return Returns modified write0
+ */
+uint16_t* text_mode_generate_cells_pair(uint16_t* write0, uint16_t* write1, const text_cell* cells,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors);
+#endif
+
 /**
  * Sets up the interpolator required by the fast font code.
  */
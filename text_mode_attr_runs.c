@@ -0,0 +1,90 @@
+#include "text_mode_attr_runs.h"
+
+
+/**
+ * Internal routine: Fills in a run with its length and resolved colors.
+ */
+static inline void text_mode_attr_run_set(text_mode_attr_run* run, unsigned count, text_color foreground,
+    text_color background, const uint16_t* palette)
+{
+    run->count = count;
+#if TEXT_MODE_PALETTIZED_COLOR
+    run->base1 = palette[foreground] + TEXT_MODE_EMBIGGENER;
+    run->base0 = palette[background];
+#else
+    (void)palette;
+    run->base1 = foreground + TEXT_MODE_EMBIGGENER;
+    run->base0 = background;
+#endif
+}
+
+
+bool __not_in_flash_func(text_mode_attr_row_update)(text_mode_attr_row* self, text_buffer* screen,
+    unsigned scanline, int row, coord_x col, coord_x cols, const text_mode_font* font, const uint16_t* palette)
+{
+    // Like the row cache, this doesn't look at the cells again, so each frame starts over.
+    if (scanline <= self->scanline)
+        text_mode_attr_row_invalidate(self);
+    self->scanline = scanline;
+    if (cols > TEXT_MODE_ATTR_RUNS_MAX_COLS || cols <= 0) {
+        text_mode_attr_row_invalidate(self);
+        return false;
+    }
+#if !TEXT_MODE_PALETTIZED_COLOR
+    palette = NULL;
+#endif
+    if (self->row == row && self->col == col && self->cols == cols && self->screen == screen && self->font == font
+        && self->palette == palette)
+        return !self->styled;
+    const text_cell* cell = text_buffer_cell(screen, col, row);
+    uint32_t* glyph_offset = self->glyph_offsets;
+    text_mode_attr_run* run = self->runs;
+    unsigned bytes_per_glyph = font->bytes_per_glyph;
+    color_pair row_colors = text_buffer_row_colors(screen, row);
+    color_pair colors = text_cell_colors(cell, row_colors);
+    unsigned count = 0;
+    self->styled = false;
+    for (coord_x i = cols; i > 0; i--, cell++) {
+        if (text_cell_style(cell)) {
+            self->styled = true;
+            break;
+        }
+        color_pair next = text_cell_colors(cell, row_colors);
+        if (next.foreground != colors.foreground || next.background != colors.background) {
+            text_mode_attr_run_set(run++, count, colors.foreground, colors.background, palette);
+            colors = next;
+            count = 0;
+        }
+        count++;
+        *glyph_offset++ = cell->glyph * bytes_per_glyph;
+    }
+    text_mode_attr_run_set(run, count, colors.foreground, colors.background, palette);
+    self->run_count = run - self->runs + 1;
+    self->screen = screen;
+    self->font = font;
+    self->palette = palette;
+    self->row = row;
+    self->col = col;
+    self->cols = cols;
+    return !self->styled;
+}
+
+
+uint16_t* text_mode_attr_row_generate_line(uint16_t* write, const text_mode_attr_row* self, unsigned char_row)
+{
+    const text_mode_font* font = self->font;
+    const unsigned char* data = text_mode_font_row(font, char_row);
+    unsigned pixels = font->scan_pixels;
+    const uint32_t* glyph_offset = self->glyph_offsets;
+    const text_mode_attr_run* run = self->runs;
+    for (unsigned runs = self->run_count; runs > 0; runs--, run++) {
+        uint16_t foreground = run->base1;
+        uint16_t background = run->base0;
+        for (unsigned count = run->count; count > 0; count--) {
+            uint32_t bits = text_mode_font_bits(font, data + *glyph_offset++);
+            for (unsigned bit = pixels; bit > 0; bit--)
+                *write++ = (bits >> (bit - 1)) & 1 ? foreground : background;
+        }
+    }
+    return write;
+}
@@ -0,0 +1,93 @@
+#ifndef TEXT_MODE_ATTR_RUNS_H
+#define TEXT_MODE_ATTR_RUNS_H
+#include "text_buffer.h"
+#include "text_mode_font.h"
+
+#ifndef TEXT_MODE_ATTR_RUNS_MAX_COLS
+/**
+ * Widest row an attribute run row can hold.
+ * Each column costs 16 bytes (a run per cell is the worst case), so the default is just under 2 K.
+ * The render core's copy lives in the 4 K scratch X bank, which it shares with core 1's 2 K stack,
+ * and text_mode.c fails to build if it doesn't fit.
+ */
+#define TEXT_MODE_ATTR_RUNS_MAX_COLS 120
+#endif
+
+/**
+ * A run of cells that all have the same colors, resolved into what the scan line generator stores into
+ * the interpolator.
+ * The field order matters: the assembly routine loads all three with a single ldmia.
+ */
+typedef struct text_mode_attr_run
+{
+    /** Number of cells in the run, never zero. */
+    uint32_t count;
+    /** Foreground color with the embiggener added, ready for BASE1. */
+    uint32_t base1;
+    /** Background color, ready for BASE0. */
+    uint32_t base0;
+} text_mode_attr_run;
+
+/**
+ * One text row, split into runs of identical colors once at its first scan line and reused for the rest
+ * of its scan lines.
+ * The scan line generator then only sets up the interpolator's colors once per run instead of once per cell,
+ * which pays off because real text mostly comes in long stretches of the same colors.
+ */
+typedef struct text_mode_attr_row
+{
+    /** Buffer the row came from. */
+    const text_buffer* screen;
+    /** Font the glyph offsets were computed for. */
+    const text_mode_font* font;
+    /** Palette the colors were decoded with. */
+    const uint16_t* palette;
+    /** Text row that is held, or -1 if none is. */
+    int row;
+    /** Scan line of the last update; one that isn't past it starts a new frame. */
+    unsigned scanline;
+    /** Column of the first cell held. */
+    coord_x col;
+    /** Number of valid entries in glyph_offsets. */
+    coord_x cols;
+    /** Number of valid entries in runs. */
+    unsigned run_count;
+    /** True if the row has cells with text_style bits, which runs can't describe, so runs is not filled in. */
+    bool styled;
+    /** Color runs, left to right */
+    text_mode_attr_run runs[TEXT_MODE_ATTR_RUNS_MAX_COLS];
+    /** Byte offset of each cell's glyph bitmap in the font data */
+    uint32_t glyph_offsets[TEXT_MODE_ATTR_RUNS_MAX_COLS];
+} text_mode_attr_row;
+
+/**
+ * Marks an attribute run row as empty, so the next update always refills it.
+ */
+static inline void text_mode_attr_row_invalidate(text_mode_attr_row* self)
+{
+    self->row = -1;
+}
+
+/**
+ * Makes sure a span of a given text row is held, rebuilding it if the row, span, buffer, font, or palette changed,
+ * or a new frame started.
+ * Changes to cells of a row that is already held do not show up until the row is rebuilt, so at the latest
+ * in the next frame, even if the same row is the last of one frame and the first of the next.
+ * @param scanline Scan line being rendered; one that isn't past the last update's starts a new frame
+ * @param col First column to hold, normally the col of the buffer's text_mode_clip
+ * @param cols Number of cells to hold
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @return false if the span is too wide, empty, or has styled cells, in which case nothing is held.
+ */
+bool text_mode_attr_row_update(text_mode_attr_row* self, text_buffer* screen, unsigned scanline, int row,
+    coord_x col, coord_x cols, const text_mode_font* font, const uint16_t* palette);
+
+/**
+ * Portable C version of the attribute-run scan line generator.
+ * @param write Write pointer
+ * @param char_row Scan line within the held text row
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_attr_row_generate_line(uint16_t* write, const text_mode_attr_row* self, unsigned char_row);
+
+#endif /* TEXT_MODE_ATTR_RUNS_H */
@@ -0,0 +1,164 @@
+#include "text_mode_bitmap.h"
+
+/**
+ * Two adjacent pixels, stored with one word write.
+ * The left pixel is in the low half, since that's the lower address.
+ */
+typedef uint32_t __attribute__((may_alias)) text_mode_bitmap_pair;
+
+
+/**
+ * Internal routine: Renders part of a row of a 1-bit bitmap.
+ */
+static inline uint16_t* text_mode_bitmap_generate_1bpp(uint16_t* write, const unsigned char* data,
+    const uint16_t* palette, unsigned first, unsigned count)
+{
+    // Each two bits of the bitmap pick a pair, with the left pixel in the more significant bit.
+    uint32_t pairs[4];
+    for (unsigned i = 0; i < 4; i++)
+        pairs[i] = palette[i >> 1] | (uint32_t)palette[i & 1] << 16;
+    data += first / 8;
+    // Bits not yet drawn are the bottom have bits of bits.
+    uint32_t bits = 0;
+    unsigned have = 0;
+    if (first & 7) {
+        bits = *data++;
+        have = 8 - (first & 7);
+    }
+    // Pairs have to be word-aligned, which the view's left edge doesn't always leave us.
+    if ((uintptr_t)write & 2 && count) {
+        if (!have) {
+            bits = *data++;
+            have = 8;
+        }
+        *write++ = palette[(bits >> --have) & 1];
+        count--;
+    }
+    text_mode_bitmap_pair* pair = (text_mode_bitmap_pair*)write;
+    for (; count >= 8; count -= 8, pair += 4) {
+        bits = bits << 8 | *data++;
+        pair[0] = pairs[(bits >> (have + 6)) & 3];
+        pair[1] = pairs[(bits >> (have + 4)) & 3];
+        pair[2] = pairs[(bits >> (have + 2)) & 3];
+        pair[3] = pairs[(bits >> have) & 3];
+    }
+    for (; count >= 2; count -= 2) {
+        if (have < 2) {
+            bits = bits << 8 | *data++;
+            have += 8;
+        }
+        have -= 2;
+        *pair++ = pairs[(bits >> have) & 3];
+    }
+    write = (uint16_t*)pair;
+    if (count) {
+        if (!have) {
+            bits = *data;
+            have = 8;
+        }
+        *write++ = palette[(bits >> (have - 1)) & 1];
+    }
+    return write;
+}
+
+
+/**
+ * Internal routine: Renders part of a row of a 4-bit bitmap.
+ */
+static inline uint16_t* text_mode_bitmap_generate_4bpp(uint16_t* write, const unsigned char* data,
+    const uint16_t* palette, unsigned first, unsigned count)
+{
+    data += first / 2;
+    // Whether the next pixel is the low nibble of *data.
+    bool odd = first & 1;
+    if ((uintptr_t)write & 2 && count) {
+        *write++ = palette[odd ? *data++ & 15 : *data >> 4];
+        odd = !odd;
+        count--;
+    }
+    text_mode_bitmap_pair* pair = (text_mode_bitmap_pair*)write;
+    if (!odd) {
+        for (; count >= 2; count -= 2) {
+            unsigned byte = *data++;
+            *pair++ = palette[byte >> 4] | (uint32_t)palette[byte & 15] << 16;
+        }
+    } else {
+        // Each pair straddles two bytes.
+        for (; count >= 2; count -= 2, data++)
+            *pair++ = palette[data[0] & 15] | (uint32_t)palette[data[1] >> 4] << 16;
+    }
+    write = (uint16_t*)pair;
+    if (count)
+        *write++ = palette[odd ? *data & 15 : *data >> 4];
+    return write;
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_bitmap_generate_pixels)(uint16_t* write, const text_mode_bitmap* bitmap,
+    unsigned y, unsigned first, unsigned count)
+{
+    const unsigned char* data = (const unsigned char*)bitmap->pixels + y * bitmap->stride;
+    if (bitmap->bits == 4)
+        return text_mode_bitmap_generate_4bpp(write, data, bitmap->palette, first, count);
+    return text_mode_bitmap_generate_1bpp(write, data, bitmap->palette, first, count);
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_bitmap_generate_cells)(uint16_t* write, const text_buffer* screen,
+    unsigned row, unsigned char_row, const text_mode_clip* clip, const void* font_row, const text_mode_font* font,
+    const uint16_t* palette, color_pair colors, text_mode_cells_kernel kernel)
+{
+    const text_cell* cells = screen->buffer + screen->size.x * row;
+#if TEXT_MODE_BITMAP_REGIONS
+    unsigned pixels = clip->pixels;
+    // Pixels of the row, from its left edge, that the clip shows; a view inside one cell shows its middle.
+    unsigned x = clip->head ? (clip->col - 1) * pixels + clip->skip : clip->col * pixels;
+    unsigned end = x + text_mode_clip_pixels(clip);
+    while (x < end) {
+        // Find the region under x, or else the column the next one starts at.
+        unsigned col = x / pixels;
+        const text_mode_bitmap* bitmap = NULL;
+        unsigned next = screen->size.x;
+        for (unsigned i = 0; i < screen->bitmap_count; i++) {
+            const text_mode_bitmap* region = &screen->bitmaps[i];
+            unsigned left = region->position.x;
+            if (row - region->position.y >= (unsigned)region->size.y || left >= next)
+                continue;
+            if (left <= col && col < left + region->size.x) {
+                bitmap = region;
+                next = left + region->size.x;
+                break;
+            }
+            if (left > col)
+                next = left;
+        }
+        unsigned stop = next * pixels < end ? next * pixels : end;
+        if (bitmap) {
+            unsigned y = (row - bitmap->position.y) * font->scan_lines + char_row;
+            write = text_mode_bitmap_generate_pixels(write, bitmap, y, x - bitmap->position.x * pixels, stop - x);
+        } else {
+            // The text between regions is clipped to them the same way the view clips the row.
+            text_mode_clip text;
+            text.pixels = pixels;
+            text.col = (x + pixels - 1) / pixels;
+            unsigned last = stop / pixels;
+            if (text.col > last)
+                write = text_mode_clip_generate_cell(write, cells + col, x - col * pixels, stop - x, font_row, font,
+                    palette, colors, kernel);
+            else {
+                text.cols = last - text.col;
+                text.head = text.col * pixels - x;
+                text.skip = text.head ? pixels - text.head : 0;
+                text.tail = stop - last * pixels;
+                write = text_mode_clip_generate_cells(write, cells, &text, font_row, font, palette, colors, kernel);
+            }
+        }
+        x = stop;
+    }
+    return write;
+#else
+    (void)row;
+    (void)char_row;
+    return text_mode_clip_generate_cells(write, cells, clip, font_row, font, palette, colors, kernel);
+#endif
+}
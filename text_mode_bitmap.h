@@ -0,0 +1,83 @@
+#ifndef TEXT_MODE_BITMAP_H
+#define TEXT_MODE_BITMAP_H
+#include "text_mode_clip.h"
+
+/**
+ * A rectangle of a text buffer, in cells, that is drawn from a bitmap instead of from its cells,
+ * for charts, logos, and other pictures that glyphs can't do, with the text path used everywhere else.
+ * The bitmap only has to cover the region, so its memory is proportional to the region's size,
+ * and the cells under it are still there, ready to show again when the region is taken away.
+ * A region covers its rows' glyph lines; spacing lines below them stay the cells' background colors.
+ * Regions aren't drawn on double size rows, and they stay put when the buffer scrolls.
+ * This is read once per scan line, so it can be changed at any time.
+ */
+typedef struct text_mode_bitmap
+{
+    /** Cell at the top left of the region. */
+    coord position;
+    /** Width and height of the region, in cells. */
+    coord size;
+    /** Bits per pixel: 1 or 4. */
+    unsigned char bits;
+    /** Bytes from one row of pixels to the next, at least enough for the region's width in pixels. */
+    unsigned short stride;
+    /**
+     * Pixel value of each of the 2 or 16 colors, which goes straight to scanvideo,
+     * so it isn't decoded by the text palette.
+     */
+    const uint16_t* palette;
+    /**
+     * Pixels, one row after another, font->scan_pixels wide and font->scan_lines high for each cell,
+     * with the leftmost pixel in the most significant bits of each byte.
+     */
+    const void* pixels;
+} text_mode_bitmap;
+
+/**
+ * Returns true if a text row shows any of the buffer's bitmaps, which is always false without
+ * TEXT_MODE_BITMAP_REGIONS.
+ * The line generators use this to send the row's lines through text_mode_bitmap_generate_cells(),
+ * so rows without bitmaps pay only this check.
+ */
+static inline bool text_mode_bitmap_on_row(const text_buffer* screen, unsigned row)
+{
+#if TEXT_MODE_BITMAP_REGIONS
+    for (unsigned i = 0; i < screen->bitmap_count; i++)
+        // A region below the row wraps around to a huge row number.
+        if (row - screen->bitmaps[i].position.y < (unsigned)screen->bitmaps[i].size.y)
+            return true;
+#else
+    (void)screen;
+    (void)row;
+#endif
+    return false;
+}
+
+/**
+ * Renders part of one row of a bitmap's pixels.
+ * Pixels are stored two to a word when write is word-aligned, from a table of pixel pairs for 1-bit bitmaps
+ * and straight from each byte for 4-bit ones.
+ * @param y Row of the bitmap's pixels
+ * @param first First pixel of the row to render
+ * @param count Number of pixels to render
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_bitmap_generate_pixels(uint16_t* write, const text_mode_bitmap* bitmap, unsigned y,
+    unsigned first, unsigned count);
+
+/**
+ * Renders one glyph line of the part of a text row a clip shows, drawing the parts of the row the buffer's
+ * bitmaps cover from their pixels and the rest with text_mode_clip_generate_cells().
+ * @param row Text row, which must be normal size
+ * @param char_row Glyph line of the row, less than font->scan_lines
+ * @param font_row Scan line of glyph 0 to render, from text_mode_font_row()
+ * @param font Font the row is drawn in, from text_mode_row_font(), which sets the size of the regions' cells
+ * @param palette Palette to decode the cells' colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @param colors Colors of every cell, from text_buffer_row_colors(); ignored unless TEXT_MODE_GLYPH_ONLY_CELLS is set
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_bitmap_generate_cells(uint16_t* write, const text_buffer* screen, unsigned row,
+    unsigned char_row, const text_mode_clip* clip, const void* font_row, const text_mode_font* font,
+    const uint16_t* palette, color_pair colors, text_mode_cells_kernel kernel);
+
+#endif /* TEXT_MODE_BITMAP_H */
@@ -0,0 +1,219 @@
+#include "text_mode_clip.h"
+#include "text_mode_style.h"
+#include "text_mode_repeat.h"
+#include <string.h>
+
+
+/**
+ * Internal routine: Runs a kernel over some cells, through text_mode_repeat_generate_cells() with
+ * TEXT_MODE_REPEAT_CELLS, or otherwise through text_mode_style_generate_cells() if cells can be styled.
+ */
+static inline uint16_t* text_mode_clip_kernel(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel)
+{
+#if TEXT_MODE_REPEAT_CELLS
+    return text_mode_repeat_generate_cells(write, cells, count, font_row, font, palette, colors, kernel);
+#elif TEXT_MODE_CELL_STYLES
+    return text_mode_style_generate_cells(write, cells, count, font_row, font, palette, colors, kernel);
+#else
+    return kernel(write, cells, count, font_row, font, palette, colors);
+#endif
+}
+
+
+/**
+ * Internal routine: Two-line version of text_mode_clip_kernel().
+ */
+static inline uint16_t* text_mode_clip_pair_kernel(uint16_t* write0, uint16_t* write1, const text_cell* cells,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_pair_kernel kernel)
+{
+#if TEXT_MODE_REPEAT_CELLS
+    return text_mode_repeat_generate_cells_pair(write0, write1, cells, count, font_row, font, palette, colors,
+        kernel);
+#elif TEXT_MODE_CELL_STYLES
+    return text_mode_style_generate_cells_pair(write0, write1, cells, count, font_row, font, palette, colors,
+        kernel);
+#else
+    return kernel(write0, write1, cells, count, font_row, font, palette, colors);
+#endif
+}
+
+
+/**
+ * Internal routine: Works out a clip for cells of a given width.
+ * @param right Pixel column of the right edge of the buffer
+ * @param pixels Width of each cell in pixels
+ */
+static inline text_mode_clip text_mode_clip_view_cells(const text_buffer* screen, unsigned right, unsigned pixels)
+{
+    text_mode_clip clip = { pixels, 0, 0, 0, 0, 0 };
+    unsigned x = screen->view.x;
+    if (x >= right)
+        return clip;
+    unsigned width = right - x;
+    if (screen->view.width && screen->view.width < width)
+        width = screen->view.width;
+    clip.col = x / pixels;
+    clip.skip = x % pixels;
+    if (clip.skip) {
+        clip.head = pixels - clip.skip;
+        if (clip.head > width)
+            clip.head = width;
+        width -= clip.head;
+        clip.col++;
+    }
+    clip.cols = width / pixels;
+    clip.tail = width % pixels;
+    return clip;
+}
+
+
+text_mode_clip __not_in_flash_func(text_mode_clip_view)(const text_buffer* screen, const text_mode_font* font)
+{
+    return text_mode_clip_view_cells(screen, screen->size.x * font->scan_pixels, font->scan_pixels);
+}
+
+
+text_mode_clip __not_in_flash_func(text_mode_clip_view_row)(const text_buffer* screen, const text_mode_font* font,
+    unsigned row)
+{
+    // A double size row is as many pixels wide as any other, so the right half of its cells are never shown.
+    unsigned pixels = font->scan_pixels << (text_buffer_row_size(screen, row) != TEXT_ROW_NORMAL);
+    return text_mode_clip_view_cells(screen, screen->size.x * font->scan_pixels, pixels);
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_clip_generate_cell)(uint16_t* write, const text_cell* cell, unsigned first,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel)
+{
+    uint16_t pixels[TEXT_MODE_MAX_FONT_WIDTH];
+    text_mode_clip_kernel(pixels, cell, 1, font_row, font, palette, colors, kernel);
+    memcpy(write, pixels + first, count * sizeof(uint16_t));
+    return write + count;
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_clip_generate_cells)(uint16_t* write, const text_cell* row,
+    const text_mode_clip* clip, const void* font_row, const text_mode_font* font, const uint16_t* palette,
+    color_pair colors, text_mode_cells_kernel kernel)
+{
+    const text_cell* cell = row + clip->col;
+    if (clip->head)
+        write = text_mode_clip_generate_cell(write, cell - 1, clip->skip, clip->head, font_row, font, palette,
+            colors, kernel);
+    if (clip->cols)
+        write = text_mode_clip_kernel(write, cell, clip->cols, font_row, font, palette, colors, kernel);
+    if (clip->tail)
+        write = text_mode_clip_generate_cell(write, cell + clip->cols, 0, clip->tail, font_row, font, palette,
+            colors, kernel);
+    return write;
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_clip_generate_double_cells)(uint16_t* write, const text_cell* cells,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel)
+{
+    unsigned pixels = count * font->scan_pixels;
+    const uint16_t* read = write + pixels;
+    const uint16_t* end = text_mode_clip_kernel(write + pixels, cells, count, font_row, font, palette, colors, kernel);
+    // Spreading out from the left never overwrites a pixel before it's read, since write only catches up
+    // with read on the last one.
+    if ((uintptr_t)write & 2) {
+        for (; read < end; read++) {
+            uint16_t pixel = *read;
+            *write++ = pixel;
+            *write++ = pixel;
+        }
+        return write;
+    }
+    uint32_t* pair = (uint32_t*)write;
+    while (read < end)
+        *pair++ = *read++ * 0x10001u;
+    return (uint16_t*)pair;
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_clip_generate_double)(uint16_t* write, const text_cell* row,
+    const text_mode_clip* clip, const void* font_row, const text_mode_font* font, const uint16_t* palette,
+    color_pair colors, text_mode_cells_kernel kernel)
+{
+    const text_cell* cell = row + clip->col;
+    uint16_t pixels[TEXT_MODE_MAX_FONT_WIDTH * 2];
+    if (clip->head) {
+        text_mode_clip_generate_double_cells(pixels, cell - 1, 1, font_row, font, palette, colors, kernel);
+        memcpy(write, pixels + clip->skip, clip->head * sizeof(uint16_t));
+        write += clip->head;
+    }
+    if (clip->cols)
+        write = text_mode_clip_generate_double_cells(write, cell, clip->cols, font_row, font, palette, colors, kernel);
+    if (clip->tail) {
+        text_mode_clip_generate_double_cells(pixels, cell + clip->cols, 1, font_row, font, palette, colors, kernel);
+        memcpy(write, pixels, clip->tail * sizeof(uint16_t));
+        write += clip->tail;
+    }
+    return write;
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_clip_generate_spacing)(uint16_t* write, const text_cell* row,
+    const text_mode_clip* clip, const text_mode_font* font, const uint16_t* palette, color_pair colors)
+{
+    const text_cell* cell = row + clip->col - (clip->head ? 1 : 0);
+    const text_cell* end = row + clip->col + clip->cols + (clip->tail ? 1 : 0);
+    unsigned pixels = clip->pixels;
+    for (; cell < end; cell++) {
+        text_color background = text_mode_style_colors(cell, colors).background;
+#if TEXT_MODE_PALETTIZED_COLOR
+        uint16_t color = palette[background];
+#else
+        (void)palette;
+        uint16_t color = background;
+#endif
+        unsigned count = pixels;
+        if (cell < row + clip->col)
+            count = clip->head;
+        else if (cell == row + clip->col + clip->cols)
+            count = clip->tail;
+        for (; count > 0; count--)
+            *write++ = color;
+    }
+    return write;
+}
+
+
+/**
+ * Internal routine: Two-line version of text_mode_clip_generate_cell().
+ */
+static uint16_t* text_mode_clip_generate_cell_pair(uint16_t* write0, uint16_t* write1, const text_cell* cell,
+    unsigned first, unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette,
+    color_pair colors, text_mode_cells_pair_kernel kernel)
+{
+    uint16_t pixels[2][TEXT_MODE_MAX_FONT_WIDTH];
+    text_mode_clip_pair_kernel(pixels[0], pixels[1], cell, 1, font_row, font, palette, colors, kernel);
+    memcpy(write0, pixels[0] + first, count * sizeof(uint16_t));
+    memcpy(write1, pixels[1] + first, count * sizeof(uint16_t));
+    return write0 + count;
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_clip_generate_cells_pair)(uint16_t* write0, uint16_t* write1,
+    const text_cell* row, const text_mode_clip* clip, const void* font_row, const text_mode_font* font,
+    const uint16_t* palette, color_pair colors, text_mode_cells_pair_kernel kernel)
+{
+    const text_cell* cell = row + clip->col;
+    uint16_t* start = write0;
+    if (clip->head)
+        write0 = text_mode_clip_generate_cell_pair(write0, write1, cell - 1, clip->skip, clip->head, font_row, font,
+            palette, colors, kernel);
+    if (clip->cols)
+        write0 = text_mode_clip_pair_kernel(write0, write1 + (write0 - start), cell, clip->cols, font_row, font,
+            palette, colors, kernel);
+    if (clip->tail)
+        write0 = text_mode_clip_generate_cell_pair(write0, write1 + (write0 - start), cell + clip->cols, 0,
+            clip->tail, font_row, font, palette, colors, kernel);
+    return write0;
+}
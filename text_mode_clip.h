@@ -0,0 +1,205 @@
+#ifndef TEXT_MODE_CLIP_H
+#define TEXT_MODE_CLIP_H
+#include "text_mode_kernel.h"
+
+/**
+ * The part of each text row that a buffer's view shows, worked out for a font.
+ * A scan line is made of the last head pixels of the cell left of col, cols whole cells starting at col,
+ * and the first tail pixels of the cell after those.
+ */
+typedef struct text_mode_clip
+{
+    /** Width of each cell in pixels: the font's width, or twice that on a double size row. */
+    unsigned pixels;
+    /** Column of the first whole cell shown. */
+    coord_x col;
+    /** Number of whole cells shown, which can be zero. */
+    coord_x cols;
+    /** Pixels cut off the left of the cell left of col. */
+    unsigned skip;
+    /** Pixels shown of the cell left of col, or 0 if the view starts on a cell boundary. */
+    unsigned head;
+    /** Pixels shown of the cell right of the whole cells, or 0 if the view ends on a cell boundary. */
+    unsigned tail;
+} text_mode_clip;
+
+/**
+ * Returns the number of scan lines from the top of one text row to the next,
+ * which is the font's height plus the buffer's line spacing.
+ * Scan lines of a row past the font's height are spacing lines, which only show the cells' backgrounds.
+ */
+static inline unsigned text_mode_row_pitch(const text_buffer* screen, const text_mode_font* font)
+{
+    return font->scan_lines + screen->line_spacing;
+}
+
+/**
+ * Returns the font a text row is drawn in, which is its entry in the buffer's row_fonts with TEXT_MODE_ROW_FONTS,
+ * or else font.
+ * @param font Font the buffer is rendered with
+ */
+static inline const text_mode_font* text_mode_row_font(const text_buffer* screen, const text_mode_font* font,
+    unsigned row)
+{
+#if TEXT_MODE_ROW_FONTS
+    if (screen->row_fonts && screen->row_fonts[row])
+        return screen->row_fonts[row];
+#else
+    (void)screen;
+    (void)row;
+#endif
+    return font;
+}
+
+/**
+ * Returns the height of a buffer in scan lines, from its line map if it has one.
+ */
+static inline unsigned text_mode_buffer_lines(const text_buffer* screen, const text_mode_font* font)
+{
+#if TEXT_MODE_ROW_FONTS
+    if (screen->line_map)
+        return screen->line_map_lines;
+#endif
+    return screen->size.y * text_mode_row_pitch(screen, font);
+}
+
+/**
+ * Works out which scan line of a buffer a scan line of the screen shows, after the view's vertical offset.
+ * @param scanline Scan line of the screen
+ * @return Scan line of the buffer, which is less than the height of the buffer in scan lines
+ */
+static inline unsigned text_mode_view_line(const text_buffer* screen, const text_mode_font* font, unsigned scanline)
+{
+    unsigned line = scanline + screen->view.y;
+    unsigned lines = text_mode_buffer_lines(screen, font);
+    // Only wrapped lines need the division.
+    return line < lines ? line : line % lines;
+}
+
+/**
+ * Works out which text row a scan line of a buffer is part of, and which scan line of the row it is.
+ * With a line map (see text_mode_row_map_update()) this is one load; without one, it's a hardware divide.
+ * Pass the row to text_mode_row_font() for the font to draw it in.
+ * @param line Scan line of the buffer, from text_mode_view_line()
+ */
+static inline text_row_line text_mode_locate_line(const text_buffer* screen, const text_mode_font* font,
+    unsigned line)
+{
+#if TEXT_MODE_ROW_FONTS
+    if (screen->line_map)
+        return screen->line_map[line];
+#endif
+    divmod_result_t r = hw_divider_divmod_u32(line, text_mode_row_pitch(screen, font));
+    return (text_row_line){ to_quotient_u32(r), to_remainder_u32(r) };
+}
+
+/**
+ * Works out which scan line of the font a scan line of a text row shows.
+ * This is just char_row, except on the halves of a double height row (see text_row_size),
+ * where each glyph line shows twice.
+ * @param char_row Scan line within the text row, which must be less than the font's height
+ */
+static inline unsigned text_mode_glyph_line(const text_buffer* screen, const text_mode_font* font, unsigned row,
+    unsigned char_row)
+{
+    switch (text_buffer_row_size(screen, row)) {
+        case TEXT_ROW_DOUBLE_HEIGHT_TOP:
+            return char_row / 2;
+        case TEXT_ROW_DOUBLE_HEIGHT_BOTTOM:
+            return (font->scan_lines + char_row) / 2;
+        default:
+            return char_row;
+    }
+}
+
+/**
+ * Works out which cells and pixels of each text row a buffer's view shows, for rows drawn normally.
+ */
+text_mode_clip text_mode_clip_view(const text_buffer* screen, const text_mode_font* font);
+
+/**
+ * Works out which cells and pixels of a given text row a buffer's view shows.
+ * This is the same as text_mode_clip_view(), except on double size rows,
+ * whose cells are twice as wide and which only show as many pixels as a normal row.
+ */
+text_mode_clip text_mode_clip_view_row(const text_buffer* screen, const text_mode_font* font, unsigned row);
+
+/**
+ * Returns the total number of pixels a clip shows.
+ */
+static inline unsigned text_mode_clip_pixels(const text_mode_clip* clip)
+{
+    return clip->head + clip->cols * clip->pixels + clip->tail;
+}
+
+/**
+ * Renders some pixels out of the middle of a single cell.
+ * The whole cell is rendered by kernel into a scratch buffer, and the pixels wanted are copied from there.
+ * @param first Leftmost pixel of the cell to write
+ * @param count Number of pixels to write
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_clip_generate_cell(uint16_t* write, const text_cell* cell, unsigned first, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel);
+
+/**
+ * Renders one scan line of the part of a text row a clip shows.
+ * The whole cells are rendered straight to write by kernel, and the cut off ones with
+ * text_mode_clip_generate_cell().
+ * @param row First cell of the text row
+ * @param font_row Scan line of glyph 0 to render, from text_mode_font_row()
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @param colors Colors of every cell, from text_buffer_row_colors(); ignored unless TEXT_MODE_GLYPH_ONLY_CELLS is set
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_clip_generate_cells(uint16_t* write, const text_cell* row, const text_mode_clip* clip,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel);
+
+/**
+ * Renders one scan line of a span of cells at double width, with every pixel from kernel stored twice.
+ * The cells are rendered into the second half of the space they will take up, and then spread out over all of it
+ * with word stores, so this needs room for count cells at twice the font's width.
+ * The parameters are the same as text_mode_cells_kernel's, plus the kernel to use.
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_clip_generate_double_cells(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel);
+
+/**
+ * Renders one scan line of the part of a double size row a clip from text_mode_clip_view_row() shows.
+ * This is text_mode_clip_generate_cells() with every cell drawn by text_mode_clip_generate_double_cells().
+ * @param row First cell of the text row
+ * @param font_row Scan line of glyph 0 to render, from text_mode_glyph_line()
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_clip_generate_double(uint16_t* write, const text_cell* row, const text_mode_clip* clip,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel);
+
+/**
+ * Renders one spacing line of the part of a text row a clip shows, which is just each cell's background color.
+ * This is for routines that have to produce pixels; text_mode_generate_spacing_line() sends the same thing
+ * to scanvideo as color runs instead.
+ * @param row First cell of the text row
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @param colors Colors of every cell, from text_buffer_row_colors(); ignored unless TEXT_MODE_GLYPH_ONLY_CELLS is set
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_clip_generate_spacing(uint16_t* write, const text_cell* row, const text_mode_clip* clip,
+    const text_mode_font* font, const uint16_t* palette, color_pair colors);
+
+/**
+ * Two-line version of text_mode_clip_generate_cells().
+ * @param write0 Write pointer for the first line
+ * @param write1 Write pointer for the second line
+ * @param font_row Scan line of glyph 0 to render on the first line; the second line uses the next one
+ * @return Returns modified write0; write1 advances the same amount
+ */
+uint16_t* text_mode_clip_generate_cells_pair(uint16_t* write0, uint16_t* write1, const text_cell* row,
+    const text_mode_clip* clip, const void* font_row, const text_mode_font* font, const uint16_t* palette,
+    color_pair colors, text_mode_cells_pair_kernel kernel);
+
+#endif /* TEXT_MODE_CLIP_H */
@@ -0,0 +1,86 @@
+#ifndef TEXT_MODE_COMPOSABLE_H
+#define TEXT_MODE_COMPOSABLE_H
+#include "pico.h"
+#include "pico/scanvideo/composable_scanline.h"
+
+/**
+ * Helpers for writing scanvideo's composable scan line tokens.
+ * 
+ * A raw run is written in two steps.
+ * First, call text_mode_begin_raw_run() and write the run's pixels to the pointer it returns.
+ * Then call text_mode_end_raw_run() with the token pointer and the end of the pixels,
+ * which rearranges them into whichever raw token fits the number of pixels.
+ */
+
+/**
+ * Reserves space for a raw run's token.
+ * @param token Where the token will go; keep this for text_mode_end_raw_run()
+ * @return Where to write the run's pixels
+ */
+static inline uint16_t* text_mode_begin_raw_run(uint16_t* token)
+{
+    return token + 2;
+}
+
+/**
+ * Finishes a raw run started with text_mode_begin_raw_run().
+ * The first pixel is moved in front of the length, which is where COMPOSABLE_RAW_RUN expects it.
+ * Runs of one or two pixels use the shorter tokens, and an empty run is removed entirely.
+ * @param token Token pointer given to text_mode_begin_raw_run()
+ * @param end End of the run's pixels
+ * @return Write pointer for the next token
+ */
+static inline uint16_t* text_mode_end_raw_run(uint16_t* token, uint16_t* end)
+{
+    size_t count = end - token - 2;
+    switch (count) {
+        case 0:
+            return token;
+        case 1:
+            token[0] = COMPOSABLE_RAW_1P;
+            token[1] = token[2];
+            return token + 2;
+        case 2:
+            token[0] = COMPOSABLE_RAW_2P;
+            token[1] = token[2];
+            token[2] = token[3];
+            return token + 3;
+        default:
+            token[0] = COMPOSABLE_RAW_RUN;
+            token[1] = token[2];
+            token[2] = count - 3;
+            return end;
+    }
+}
+
+/**
+ * Writes a run of a single color.
+ * @param count Number of pixels, which must be at least three
+ * @return Write pointer for the next token
+ */
+static inline uint16_t* text_mode_color_run(uint16_t* write, uint16_t color, unsigned count)
+{
+    write[0] = COMPOSABLE_COLOR_RUN;
+    write[1] = color;
+    write[2] = count - 3;
+    return write + 3;
+}
+
+/**
+ * Ends a scan line, padding it out to a whole number of words.
+ * @param start Start of the scan line buffer
+ * @param write Write pointer after the last token
+ * @return Write pointer after the end-of-line token
+ */
+static inline uint16_t* text_mode_end_scanline(uint16_t* start, uint16_t* write)
+{
+    if ((write - start) & 1) {
+        *write++ = COMPOSABLE_EOL_ALIGN;
+    } else {
+        *write++ = COMPOSABLE_EOL_SKIP_ALIGN;
+        *write++ = 0;
+    }
+    return write;
+}
+
+#endif /* TEXT_MODE_COMPOSABLE_H */
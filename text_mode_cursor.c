@@ -0,0 +1,71 @@
+#include "text_mode_cursor.h"
+#include "text_mode_style.h"
+
+
+/**
+ * Internal routine: Works out which pixels of a scan line the cursor covers.
+ * @param first Set to the first pixel covered, counting from the left edge of the view
+ * @param count Set to the number of pixels covered
+ * @return Returns false if the line doesn't show any of the cursor
+ */
+static inline bool text_mode_cursor_span(const text_mode_cursor* cursor, unsigned scanline, unsigned frame,
+    const text_buffer* screen, const text_mode_font* font, unsigned* first, unsigned* count)
+{
+    if (!cursor || !text_mode_cursor_lit(cursor, frame))
+        return false;
+    coord_y row = cursor->position.y;
+    if (row < 0 || row >= screen->size.y || cursor->position.x < 0 || cursor->position.x >= screen->size.x)
+        return false;
+    text_row_line at = text_mode_locate_line(screen, font, text_mode_view_line(screen, font, scanline));
+    font = text_mode_row_font(screen, font, row);
+    if (at.row != row || at.line >= font->scan_lines)
+        return false;
+    if (cursor->shape == TEXT_CURSOR_UNDERLINE) {
+        unsigned glyph_line = text_mode_glyph_line(screen, font, row, at.line);
+        if (glyph_line < font->scan_lines - (font->scan_lines + 7) / 8)
+            return false;
+    }
+    text_mode_clip clip = text_mode_clip_view_row(screen, font, row);
+    unsigned left = cursor->position.x * clip.pixels;
+    unsigned right = left + (cursor->shape == TEXT_CURSOR_BAR ? (clip.pixels + 7) / 8 : clip.pixels);
+    unsigned view_left = screen->view.x;
+    unsigned view_right = view_left + text_mode_clip_pixels(&clip);
+    if (left < view_left)
+        left = view_left;
+    if (right > view_right)
+        right = view_right;
+    if (left >= right)
+        return false;
+    *first = left - view_left;
+    *count = right - left;
+    return true;
+}
+
+
+bool __not_in_flash_func(text_mode_cursor_on_line)(const text_mode_cursor* cursor, unsigned scanline,
+    unsigned frame, const text_buffer* screen, const text_mode_font* font)
+{
+    unsigned first, count;
+    return text_mode_cursor_span(cursor, scanline, frame, screen, font, &first, &count);
+}
+
+
+void __not_in_flash_func(text_mode_cursor_draw)(uint16_t* line, const text_mode_cursor* cursor, unsigned scanline,
+    unsigned frame, const text_buffer* screen, const text_mode_font* font, const uint16_t* palette)
+{
+    unsigned first, count;
+    if (!text_mode_cursor_span(cursor, scanline, frame, screen, font, &first, &count))
+        return;
+    coord_y row = cursor->position.y;
+    const text_cell* cell = screen->buffer + screen->size.x * row + cursor->position.x;
+    color_pair colors = text_mode_style_colors(cell, text_buffer_row_colors(screen, row));
+#if TEXT_MODE_PALETTIZED_COLOR
+    uint16_t foreground = palette[colors.foreground], background = palette[colors.background];
+#else
+    (void)palette;
+    uint16_t foreground = colors.foreground, background = colors.background;
+#endif
+    // Anything that isn't the background is glyph, which also covers half bright foregrounds.
+    for (uint16_t* pixel = line + first; pixel < line + first + count; pixel++)
+        *pixel = *pixel == background ? foreground : background;
+}
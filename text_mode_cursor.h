@@ -0,0 +1,92 @@
+#ifndef TEXT_MODE_CURSOR_H
+#define TEXT_MODE_CURSOR_H
+#include "text_mode_clip.h"
+
+/**
+ * Shapes a text_mode_cursor can be drawn in.
+ */
+typedef enum text_cursor_shape
+{
+    /** The whole cell. */
+    TEXT_CURSOR_BLOCK = 0,
+    /** The bottom eighth of the glyph lines, but at least one. */
+    TEXT_CURSOR_UNDERLINE = 1,
+    /** The left eighth of the cell's pixels, but at least one. */
+    TEXT_CURSOR_BAR = 2,
+} text_cursor_shape;
+
+/**
+ * A text cursor drawn over a buffer by the scan line generator, which never touches the buffer's cells.
+ * Pixels under the cursor are drawn in the cell's other color: its background where the glyph is set,
+ * and its foreground everywhere else.
+ * This is read once per scan line, so it can be moved at any time; at worst a scan line or two shows
+ * the cursor in its old place.
+ */
+typedef struct text_mode_cursor
+{
+    /** Cell the cursor is on. */
+    coord position;
+    /** A text_cursor_shape. */
+    unsigned char shape;
+    /** Frames the cursor stays on, and then off, for each blink, or 0 to not blink. */
+    unsigned short blink_frames;
+    /** Frame number the current blink started on, which is always shown; see text_mode_cursor_restart(). */
+    uint16_t blink_start;
+} text_mode_cursor;
+
+/**
+ * Restarts the cursor's blink, so it shows straight away, like after a key press.
+ * @param frame Current frame number, from scanvideo_frame_number()
+ */
+static inline void text_mode_cursor_restart(text_mode_cursor* cursor, unsigned frame)
+{
+    cursor->blink_start = frame;
+}
+
+/**
+ * Moves the cursor to the buffer's logical cursor and restarts its blink.
+ * @param frame Current frame number, from scanvideo_frame_number()
+ */
+static inline void text_mode_cursor_follow(text_mode_cursor* cursor, const text_buffer* screen, unsigned frame)
+{
+    cursor->position = screen->cursor;
+    text_mode_cursor_restart(cursor, frame);
+}
+
+/**
+ * Returns true if the cursor is on during a frame, or false if it's blinked off.
+ * @param frame Frame number, from scanvideo_frame_number()
+ */
+static inline bool text_mode_cursor_lit(const text_mode_cursor* cursor, unsigned frame)
+{
+    if (!cursor->blink_frames)
+        return true;
+    // Frame numbers are 16 bits, so the count wraps around with them.
+    uint16_t elapsed = frame - cursor->blink_start;
+    return !(elapsed / cursor->blink_frames & 1);
+}
+
+/**
+ * Returns true if a scan line of the screen shows any of the cursor during a frame.
+ * The render loop uses this to send the line as one raw run that the cursor can be drawn into.
+ * @param cursor Cursor to draw, or NULL for none
+ * @param scanline Scanline number
+ * @param frame Frame number, from scanvideo_frame_number()
+ */
+bool text_mode_cursor_on_line(const text_mode_cursor* cursor, unsigned scanline, unsigned frame,
+    const text_buffer* screen, const text_mode_font* font);
+
+/**
+ * Draws the cursor over a scan line that has already been rendered, such as by text_mode_generate_line().
+ * Only the pixels under the cursor are read and written, so this costs nothing on other lines
+ * but working out that the cursor isn't there.
+ * @param line First pixel of the scan line, which is the first pixel the buffer's view shows
+ * @param cursor Cursor to draw, or NULL for none
+ * @param scanline Scanline number the line was rendered for
+ * @param frame Frame number, from scanvideo_frame_number()
+ * @param palette Palette the line was rendered with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ */
+void text_mode_cursor_draw(uint16_t* line, const text_mode_cursor* cursor, unsigned scanline, unsigned frame,
+    const text_buffer* screen, const text_mode_font* font, const uint16_t* palette);
+
+#endif /* TEXT_MODE_CURSOR_H */
@@ -0,0 +1,88 @@
+#include "text_mode_font.h"
+#include <string.h>
+
+
+void text_mode_font_transpose(text_mode_font* dest, void* data, const text_mode_font* source)
+{
+    const unsigned char* read = source->data;
+    unsigned char* write = data;
+    size_t plane = (size_t)source->glyph_count * source->bytes_per_scan;
+    for (unsigned glyph = 0; glyph < source->glyph_count; glyph++)
+        for (unsigned line = 0; line < source->scan_lines; line++)
+            memcpy(write + line * plane + glyph * source->bytes_per_scan,
+                read + glyph * source->bytes_per_glyph + line * source->scan_line_stride,
+                source->bytes_per_scan);
+    // The descriptor's members are const, so it has to be built whole and then copied into place.
+    text_mode_font font = {
+        .scan_pixels = source->scan_pixels,
+        .scan_lines = source->scan_lines,
+        .bytes_per_scan = source->bytes_per_scan,
+        .bytes_per_glyph = source->bytes_per_scan,
+        .data = data,
+        .glyph_count = source->glyph_count,
+        .scan_line_stride = plane,
+        .layout = TEXT_MODE_FONT_SCAN_LINE_MAJOR,
+        .blank_rows = source->blank_rows
+    };
+    memcpy(dest, &font, sizeof(font));
+}
+
+
+void text_mode_font_relocate(text_mode_font* dest, void* data, const text_mode_font* source, unsigned glyph_count)
+{
+    const unsigned char* read = source->data;
+    unsigned char* write = data;
+    bool scan_line_major = source->layout == TEXT_MODE_FONT_SCAN_LINE_MAJOR;
+    // Fewer glyphs make each plane of a scan-line-major font shorter, so it has to be copied one plane at a time.
+    size_t plane = (size_t)glyph_count * source->bytes_per_scan;
+    unsigned stride = scan_line_major ? plane : source->scan_line_stride;
+    if (scan_line_major)
+        for (unsigned line = 0; line < source->scan_lines; line++)
+            memcpy(write + line * plane, read + line * source->scan_line_stride, plane);
+    else
+        memcpy(write, read, (size_t)glyph_count * source->bytes_per_glyph);
+    text_mode_font font = {
+        .scan_pixels = source->scan_pixels,
+        .scan_lines = source->scan_lines,
+        .bytes_per_scan = source->bytes_per_scan,
+        .bytes_per_glyph = source->bytes_per_glyph,
+        .data = data,
+        .glyph_count = glyph_count,
+        .scan_line_stride = stride,
+        .layout = source->layout,
+        .blank_rows = source->blank_rows
+    };
+    memcpy(dest, &font, sizeof(font));
+}
+
+
+void text_mode_font_add_blank_rows(text_mode_font* dest, uint32_t* blank_rows, const text_mode_font* source)
+{
+    unsigned lines = source->scan_lines < 32 ? source->scan_lines : 32;
+    for (unsigned glyph = 0; glyph < source->glyph_count; glyph++) {
+        uint32_t mask = 0;
+        for (unsigned line = 0; line < lines; line++) {
+            const unsigned char* row = (const unsigned char*)text_mode_font_row(source, line)
+                + glyph * source->bytes_per_glyph;
+            bool blank = true;
+            for (unsigned i = 0; i < source->bytes_per_scan; i++)
+                if (row[i])
+                    blank = false;
+            if (blank)
+                mask |= 1u << line;
+        }
+        blank_rows[glyph] = mask;
+    }
+    text_mode_font font = {
+        .scan_pixels = source->scan_pixels,
+        .scan_lines = source->scan_lines,
+        .bytes_per_scan = source->bytes_per_scan,
+        .bytes_per_glyph = source->bytes_per_glyph,
+        .data = source->data,
+        .glyph_count = source->glyph_count,
+        .scan_line_stride = source->scan_line_stride,
+        .layout = source->layout,
+        .blank_rows = blank_rows
+    };
+    memcpy(dest, &font, sizeof(font));
+}
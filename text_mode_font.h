@@ -1,5 +1,9 @@
 #ifndef TEXT_MODE_FONT_H
 #define TEXT_MODE_FONT_H
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
 
 #if TEXT_MODE_MAX_FONT_WIDTH <= 8
 #define TEXT_MODE_FONT_DATA_TYPE unsigned char
@@ -9,9 +13,77 @@
 #define TEXT_MODE_FONT_DATA_TYPE unsigned int
 #endif
 
+#ifndef TEXT_MODE_FONT_STORAGE_WIDTHS
+/**
+ * With TEXT_MODE_PER_FONT_STORAGE, the storage widths fonts may use, as bytes (1, 2, and 4) ORed together.
+ * The interpolator kernels get a copy in scratch Y for each of these TEXT_MODE_FONT_DATA_TYPE allows,
+ * so leave out the widths no font you render uses; text_mode_font_storage() asserts that every font's is here.
+ */
+#define TEXT_MODE_FONT_STORAGE_WIDTHS (1 | 2 | 4)
+#endif
+
+#if TEXT_MODE_SPLIT_DECODE
+#if TEXT_MODE_MAX_FONT_WIDTH > 32
+#error "TEXT_MODE_MAX_FONT_WIDTH must be less than 33."
+#endif
+#elif TEXT_MODE_MAX_FONT_WIDTH > 30
+#error "TEXT_MODE_MAX_FONT_WIDTH must be less than 31 unless TEXT_MODE_SPLIT_DECODE is set."
+#endif
+
+/**
+ * Bit of the interpolator's accumulator that selects between foreground and background
+ * for a given maximum font width, decoding each glyph row in a single pass.
+ * Each pixel of font width past 15 costs one bit of usable color.
+ */
+#define TEXT_MODE_SHIFT_AMOUNT_FOR_WIDTH(width) ((width) <= 15 ? 17 : 17 - ((width) - 15))
+
+/**
+ * Number of pixels the interpolator can decode from one load of its accumulators without giving up
+ * any color bits.
+ * With TEXT_MODE_SPLIT_DECODE, wider glyph rows are decoded in passes of this many pixels.
+ */
+#define TEXT_MODE_SPLIT_PIXELS 15
+
+/** Shift amount for TEXT_MODE_MAX_FONT_WIDTH. */
+#if TEXT_MODE_SPLIT_DECODE
+#define TEXT_MODE_SHIFT_AMOUNT TEXT_MODE_SHIFT_AMOUNT_FOR_WIDTH(TEXT_MODE_SPLIT_PIXELS)
+#else
+#define TEXT_MODE_SHIFT_AMOUNT TEXT_MODE_SHIFT_AMOUNT_FOR_WIDTH(TEXT_MODE_MAX_FONT_WIDTH)
+#endif
+
+/**
+ * Added to the foreground color so the interpolator's clamp always picks it for a set bit.
+ * Only the low 16 bits end up in the scan line buffer, so for fonts wider than 15 pixels
+ * this bit also shows up in foreground pixels, unless TEXT_MODE_SPLIT_DECODE is set.
+ */
+#define TEXT_MODE_EMBIGGENER (1u << (TEXT_MODE_SHIFT_AMOUNT - 1))
+
+/**
+ * Number of low bits of a color that are guaranteed to decode correctly.
+ * Foreground colors must fit in this many bits or they carry into the bit being tested.
+ */
+#define TEXT_MODE_COLOR_BITS (TEXT_MODE_SHIFT_AMOUNT > 16 ? 16 : TEXT_MODE_SHIFT_AMOUNT - 1)
+
+/**
+ * Ways the bitmaps of a text_mode_font can be arranged.
+ */
+typedef enum text_mode_font_layout
+{
+    /** data[glyph][scan_line]: each glyph's bitmap is contiguous. */
+    TEXT_MODE_FONT_GLYPH_MAJOR = 0,
+    /**
+     * data[scan_line][glyph]: the same scan line of every glyph is contiguous,
+     * so rendering one scan line only reads from one small part of the font.
+     */
+    TEXT_MODE_FONT_SCAN_LINE_MAJOR = 1,
+} text_mode_font_layout;
+
 /**
  * Contains font information used by the text_mode scan line generator routines.
- * The font data supplied shall be formatted as an array of fixed-size glyph bitmaps.
+ * The font data supplied shall be formatted as an array of fixed-size glyph bitmaps,
+ * arranged as described by layout.
+ * The scan line generator finds a glyph's scan line at
+ * data + glyph * bytes_per_glyph + scan_line * scan_line_stride.
  */
 typedef struct text_mode_font
 {
@@ -27,12 +99,15 @@ typedef struct text_mode_font
     const unsigned char scan_lines;
     /**
      * Number of bytes per scan line.
+     * Glyph rows are read as TEXT_MODE_FONT_DATA_TYPE, unless TEXT_MODE_PER_FONT_STORAGE is set, in which case
+     * this is 1, 2, or 4, and rows are read with this many bytes, up to the size of TEXT_MODE_FONT_DATA_TYPE.
      * 
      * This value is cached for fast indexing.
      */
     const unsigned char bytes_per_scan;
     /**
-     * Number of bytes per glyph in the data array.
+     * Number of bytes from one glyph to the next in the data array.
+     * For a scan-line-major font, this is the same as bytes_per_scan.
      * 
      * This value is cached for fast indexing.
      */
@@ -41,6 +116,126 @@ typedef struct text_mode_font
      * Pointer to font data.
      */
     const void* const data;
+    /**
+     * Number of glyphs in the data array.
+     * This is 32 bits wide, along with scan_line_stride, since a scan-line-major copy of a large font can have
+     * more than 65535 bytes per scan line plane.
+     */
+    const uint32_t glyph_count;
+    /**
+     * Number of bytes from one scan line of a glyph to the next in the data array.
+     * For a glyph-major font, this is the same as bytes_per_scan.
+     * 
+     * This value is cached for fast indexing.
+     */
+    const uint32_t scan_line_stride;
+    /**
+     * Arrangement of the data array, see text_mode_font_layout.
+     */
+    const unsigned char layout;
+    /**
+     * Optional per-glyph bitmasks of which scan lines are completely blank, or NULL.
+     * Bit n of blank_rows[glyph] is set if scan line n of that glyph has no pixels set.
+     * This lets the scan line generator send runs of blank cells as single color runs.
+     * Only the first 32 scan lines can be described.
+     */
+    const uint32_t* const blank_rows;
 } text_mode_font;
 
+/**
+ * Returns the number of bytes of bitmap data a font has.
+ */
+static inline size_t text_mode_font_data_size(const text_mode_font* font)
+{
+    return (size_t)font->glyph_count * font->scan_lines * font->bytes_per_scan;
+}
+
+/**
+ * Returns a pointer to a given scan line of glyph 0.
+ * Adding glyph * bytes_per_glyph bytes to this gives that scan line of any other glyph.
+ * This works for either font layout: a scan-line-major font just has a long stride and short glyphs.
+ */
+static inline const void* text_mode_font_row(const text_mode_font* font, unsigned scan_line)
+{
+    return (const unsigned char*)font->data + scan_line * font->scan_line_stride;
+}
+
+/**
+ * Returns the storage width glyph rows of a font are read with, in bytes, which is its bytes_per_scan with
+ * TEXT_MODE_PER_FONT_STORAGE, capped at sizeof(TEXT_MODE_FONT_DATA_TYPE), and otherwise that size.
+ * No glyph is wider than TEXT_MODE_MAX_FONT_WIDTH, so on a little-endian CPU the low bytes of a wider row
+ * hold all of its pixels.
+ * Asserts that the width is one of TEXT_MODE_FONT_STORAGE_WIDTHS, since the kernels have no copy for the others.
+ */
+static inline unsigned text_mode_font_storage(const text_mode_font* font)
+{
+#if TEXT_MODE_PER_FONT_STORAGE
+    if (font->bytes_per_scan < sizeof(TEXT_MODE_FONT_DATA_TYPE)) {
+        assert(font->bytes_per_scan & TEXT_MODE_FONT_STORAGE_WIDTHS);
+        return font->bytes_per_scan;
+    }
+    assert(sizeof(TEXT_MODE_FONT_DATA_TYPE) & TEXT_MODE_FONT_STORAGE_WIDTHS);
+#else
+    (void)font;
+#endif
+    return sizeof(TEXT_MODE_FONT_DATA_TYPE);
+}
+
+/**
+ * Returns the bits of one scan line of a glyph, read with text_mode_font_storage() bytes.
+ * @param row Scan line of the glyph, such as text_mode_font_row() plus glyph * bytes_per_glyph
+ */
+static inline uint32_t text_mode_font_bits(const text_mode_font* font, const void* row)
+{
+#if TEXT_MODE_PER_FONT_STORAGE
+    switch (text_mode_font_storage(font)) {
+    case 1:
+        return *(const uint8_t*)row;
+    case 2:
+        return *(const uint16_t*)row;
+    }
+#else
+    (void)font;
+#endif
+    return *(const TEXT_MODE_FONT_DATA_TYPE*)row;
+}
+
+/**
+ * Returns true if a given scan line of a glyph is known to be blank.
+ */
+static inline bool text_mode_font_row_is_blank(const text_mode_font* font, unsigned glyph, unsigned scan_line)
+{
+    return font->blank_rows && scan_line < 32 && (font->blank_rows[glyph] >> scan_line) & 1;
+}
+
+/**
+ * Makes a copy of a font descriptor with blank scan line metadata added.
+ * The bitmaps are not copied.
+ * @param dest Font descriptor to initialize
+ * @param blank_rows Buffer for the metadata, which must have room for source->glyph_count entries
+ * @param source Font to describe
+ */
+void text_mode_font_add_blank_rows(text_mode_font* dest, uint32_t* blank_rows, const text_mode_font* source);
+
+/**
+ * Makes a scan-line-major copy of a font's bitmaps.
+ * @param dest Font descriptor to initialize for the copy
+ * @param data Buffer for the copied bitmaps, which must be text_mode_font_data_size(source) bytes
+ * @param source Font to copy, in either layout
+ */
+void text_mode_font_transpose(text_mode_font* dest, void* data, const text_mode_font* source);
+
+/**
+ * Copies the first glyphs of a font's bitmaps to somewhere else, in the same layout, such as a RAM bank
+ * the other core doesn't use much (see text_mode_pin_font()).
+ * The copy keeps the source's blank scan line metadata.
+ * Cutting a font down to fewer glyphs is only safe if nothing it renders uses the ones left out.
+ * @param dest Font descriptor to initialize for the copy
+ * @param data Buffer for the copied bitmaps, which must be glyph_count * source->scan_lines *
+ * source->bytes_per_scan bytes
+ * @param source Font to copy, in either layout
+ * @param glyph_count Number of glyphs to copy, up to source->glyph_count
+ */
+void text_mode_font_relocate(text_mode_font* dest, void* data, const text_mode_font* source, unsigned glyph_count);
+
 #endif /* TEXT_MODE_FONT_H */
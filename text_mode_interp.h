@@ -0,0 +1,53 @@
+#ifndef TEXT_MODE_INTERP_H
+#define TEXT_MODE_INTERP_H
+#include "hardware/interp.h"
+#include "text_mode_font.h"
+
+/**
+ * Programs an interpolator the way the font decoder expects.
+ * This is shared with the host build so the interpolator model runs exactly the same configuration.
+ * 
+ * LANE1 shifts the glyph bits right by one every POP and adds BASE1 (the embiggened foreground color)
+ * below the masked-off bits; LANE0 tests a single bit of that and clamps it to BASE0 or BASE1.
+ * Because LANE0 cross-feeds its result, each POP0 advances both accumulators to the next pixel.
+ * @param interp Must be INTERP1 because only it has clamp mode.
+ * @param shift_amount Bit being tested, normally TEXT_MODE_SHIFT_AMOUNT
+ */
+static inline void text_mode_configure_interp(interp_hw_t* interp, unsigned shift_amount)
+{
+    interp_config lane0 = interp_default_config();
+    interp_config_set_shift(&lane0, 0);
+    interp_config_set_mask(&lane0, shift_amount, shift_amount);
+    interp_config_set_clamp(&lane0, true);
+    interp_config_set_cross_result(&lane0, true);
+    interp_set_config(interp, 0, &lane0);
+    interp_config lane1 = interp_default_config();
+    interp_config_set_shift(&lane1, 1);
+    interp_config_set_mask(&lane1, shift_amount, 31);
+    interp_set_config(interp, 1, &lane1);
+}
+
+/**
+ * Programs an interpolator to cut a glyph row into the passes that TEXT_MODE_SPLIT_DECODE decodes it in.
+ * Passes are TEXT_MODE_SPLIT_PIXELS wide and lined up from the left edge of the glyph,
+ * so the rightmost pixels, which are decoded first, are the partial pass.
+ * With the raw glyph row written to both accumulators, PEEK0 has it shifted down to the leftmost pass's
+ * bits, and PEEK1 to the middle pass's bits for rows more than two passes wide.
+ * The decoder only uses the low TEXT_MODE_SPLIT_PIXELS bits of those.
+ * @param interp Should be INTERP0, since INTERP1 is busy decoding.
+ * @param width Width of the font being decoded
+ */
+static inline void text_mode_configure_split_interp(interp_hw_t* interp, unsigned width)
+{
+    interp_config lane0 = interp_default_config();
+    interp_config_set_shift(&lane0, width > TEXT_MODE_SPLIT_PIXELS ? width - TEXT_MODE_SPLIT_PIXELS : 0);
+    interp_set_config(interp, 0, &lane0);
+    interp_config lane1 = interp_default_config();
+    interp_config_set_shift(&lane1, width > 2 * TEXT_MODE_SPLIT_PIXELS ? width - 2 * TEXT_MODE_SPLIT_PIXELS : 0);
+    interp_set_config(interp, 1, &lane1);
+    // PEEK0 and PEEK1 add the BASE registers, which the application may have left set.
+    interp_set_base(interp, 0, 0);
+    interp_set_base(interp, 1, 0);
+}
+
+#endif /* TEXT_MODE_INTERP_H */
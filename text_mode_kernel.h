@@ -0,0 +1,34 @@
+#ifndef TEXT_MODE_KERNEL_H
+#define TEXT_MODE_KERNEL_H
+#include "text_buffer.h"
+#include "text_mode_font.h"
+
+/**
+ * A routine that renders one scan line of a span of cells as raw pixels,
+ * such as text_mode_generate_cells() or text_mode_reference_generate_cells().
+ * Routines that build scan lines out of several pieces take one of these,
+ * so the same code runs with the assembly kernel on the device and the C kernel on a host.
+ * @param write Write pointer
+ * @param cells First cell to render
+ * @param count Number of cells to render, which is never zero
+ * @param font_row Scan line of glyph 0 to render, from text_mode_font_row()
+ * @param font Pointer to font to use for rendering
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @param colors Colors of every cell, from text_buffer_row_colors(); ignored unless TEXT_MODE_GLYPH_ONLY_CELLS is set
+ * @return Returns modified write pointer
+ */
+typedef uint16_t* (*text_mode_cells_kernel)(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors);
+
+/**
+ * A routine that renders two consecutive scan lines of a span of cells,
+ * such as text_mode_generate_cells_pair() or text_mode_reference_generate_cells_pair().
+ * @param write0 Write pointer for the first line
+ * @param write1 Write pointer for the second line
+ * @param font_row Scan line of glyph 0 to render on the first line; the second line uses the next one
+ * @return Returns modified write0; write1 advances the same amount
+ */
+typedef uint16_t* (*text_mode_cells_pair_kernel)(uint16_t* write0, uint16_t* write1, const text_cell* cells,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors);
+
+#endif /* TEXT_MODE_KERNEL_H */
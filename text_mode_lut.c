@@ -0,0 +1,133 @@
+#include "text_mode_lut.h"
+#include "text_mode_clip.h"
+#include "text_mode_bitmap.h"
+#include "text_mode_tile.h"
+
+#if TEXT_MODE_LUT_CACHE_SIZE & (TEXT_MODE_LUT_CACHE_SIZE - 1)
+#error "TEXT_MODE_LUT_CACHE_SIZE must be a power of two."
+#endif
+
+/**
+ * Two adjacent pixels, stored with one word write.
+ * The left pixel is in the low half, since that's the lower address.
+ */
+typedef uint32_t __attribute__((may_alias)) text_mode_pixel_pair;
+
+/**
+ * Expansion table for one foreground/background combination.
+ */
+typedef struct text_mode_lut_entry
+{
+    /** Colors this table is for, from text_mode_lut_key(). */
+    uint32_t key;
+    /** Pixel pairs indexed by two glyph bits, left pixel in the higher bit. */
+    text_mode_pixel_pair pairs[4];
+} text_mode_lut_entry;
+
+/**
+ * Key that no cell produces in palettized mode.
+ * In direct color mode, white-on-white does produce it, so empty entries hold that table.
+ */
+#define TEXT_MODE_LUT_UNUSED_KEY 0xFFFFFFFFu
+
+
+/**
+ * Internal routine: Combines a cell's colors into a cache key.
+ */
+static inline uint32_t text_mode_lut_key(color_pair colors)
+{
+    return colors.foreground | (uint32_t)colors.background << (8 * sizeof(text_color));
+}
+
+
+/**
+ * Internal routine: Converts a cell color into a 16-bit pixel value.
+ */
+static inline uint16_t text_mode_lut_color(text_color color, const uint16_t* palette)
+{
+#if TEXT_MODE_PALETTIZED_COLOR
+    return palette[color];
+#else
+    (void)palette;
+    return color;
+#endif
+}
+
+
+/**
+ * Internal routine: Builds the table for a pair of pixel values.
+ */
+static inline void text_mode_lut_fill(text_mode_lut_entry* entry, uint32_t key, uint16_t foreground,
+    uint16_t background)
+{
+    entry->key = key;
+    entry->pairs[0] = background | (uint32_t)background << 16;
+    entry->pairs[1] = background | (uint32_t)foreground << 16;
+    entry->pairs[2] = foreground | (uint32_t)background << 16;
+    entry->pairs[3] = foreground | (uint32_t)foreground << 16;
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_lut_generate_cells)(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors)
+{
+    text_mode_lut_entry cache[TEXT_MODE_LUT_CACHE_SIZE];
+    // Only the low 16 bits of the interpolator's BASE1 get stored, so match that.
+    text_mode_lut_fill(&cache[0], TEXT_MODE_LUT_UNUSED_KEY, (uint16_t)(0xFFFF + TEXT_MODE_EMBIGGENER), 0xFFFF);
+    for (unsigned i = 1; i < TEXT_MODE_LUT_CACHE_SIZE; i++)
+        cache[i] = cache[0];
+    const unsigned char* data = font_row;
+    unsigned pixels = font->scan_pixels;
+    unsigned bytes_per_glyph = font->bytes_per_glyph;
+    for (const text_cell* cell = cells; count > 0; count--, cell++) {
+        color_pair cell_colors = text_cell_colors(cell, colors);
+        uint32_t key = text_mode_lut_key(cell_colors);
+        text_mode_lut_entry* entry =
+            &cache[(cell_colors.foreground ^ cell_colors.background) & (TEXT_MODE_LUT_CACHE_SIZE - 1)];
+        if (entry->key != key)
+            text_mode_lut_fill(entry, key,
+                text_mode_lut_color(cell_colors.foreground, palette) + TEXT_MODE_EMBIGGENER,
+                text_mode_lut_color(cell_colors.background, palette));
+        uint32_t bits = text_mode_font_bits(font, data + cell->glyph * bytes_per_glyph);
+        unsigned bit = pixels;
+        // Pairs have to be word-aligned, which odd widths and raw run tokens don't always leave us.
+        if ((uintptr_t)write & 2) {
+            bit--;
+            *write++ = (uint16_t)entry->pairs[(bits >> bit) & 1 ? 3 : 0];
+        }
+        text_mode_pixel_pair* pair = (text_mode_pixel_pair*)write;
+        for (; bit >= 2; bit -= 2)
+            *pair++ = entry->pairs[(bits >> (bit - 2)) & 3];
+        write = (uint16_t*)pair;
+        if (bit)
+            *write++ = (uint16_t)entry->pairs[bits & 1 ? 3 : 0];
+    }
+    return write;
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_lut_generate_line)(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette)
+{
+    text_row_line at = text_mode_locate_line(screen, font, text_mode_view_line(screen, font, scanline));
+    unsigned row = at.row;
+    unsigned char_row = at.line;
+    font = text_mode_row_font(screen, font, row);
+    text_mode_clip clip = text_mode_clip_view_row(screen, font, row);
+    if (char_row >= font->scan_lines)
+        return text_mode_clip_generate_spacing(write, text_buffer_cell(screen, 0, row), &clip, font, palette,
+            text_buffer_row_colors(screen, row));
+    const void* font_row = text_mode_font_row(font, text_mode_glyph_line(screen, font, row, char_row));
+    if (text_buffer_row_size(screen, row))
+        return text_mode_clip_generate_double(write, text_buffer_cell(screen, 0, row), &clip, font_row, font, palette,
+            text_buffer_row_colors(screen, row), text_mode_lut_generate_cells);
+    const text_mode_tiles* tiles = text_mode_row_tiles(screen, row);
+    if (tiles)
+        return text_mode_tile_generate_line(write, text_buffer_cell(screen, 0, row), &clip, tiles, char_row, font,
+            text_buffer_row_colors(screen, row));
+    if (text_mode_bitmap_on_row(screen, row))
+        return text_mode_bitmap_generate_cells(write, screen, row, char_row, &clip, font_row, font, palette,
+            text_buffer_row_colors(screen, row), text_mode_lut_generate_cells);
+    return text_mode_clip_generate_cells(write, text_buffer_cell(screen, 0, row), &clip, font_row, font, palette,
+        text_buffer_row_colors(screen, row), text_mode_lut_generate_cells);
+}
@@ -0,0 +1,50 @@
+#ifndef TEXT_MODE_LUT_H
+#define TEXT_MODE_LUT_H
+#include "text_mode_kernel.h"
+
+#ifndef TEXT_MODE_LUT_CACHE_SIZE
+/**
+ * Number of color pairs whose expansion tables are kept during one call to text_mode_lut_generate_cells(),
+ * which renders a span of cells on one scan line.
+ * Must be a power of two.
+ * Text usually only has a handful of color combinations on one row, so this can be small.
+ */
+#define TEXT_MODE_LUT_CACHE_SIZE 8
+#endif
+
+/**
+ * Renders one scan line of a span of cells without using the interpolator.
+ * Glyph bits are expanded two at a time through a four-entry table of pixel pairs for the cell's
+ * foreground and background colors, and each pair is stored as a single word.
+ * Tables for recently seen color pairs are cached for the rest of the call, not for the rest of the text row,
+ * so each scan line builds its own, since keeping them between calls would need state for each rendering core.
+ * For colors within TEXT_MODE_COLOR_BITS, the output is identical to text_mode_generate_cells(), including the
+ * embiggener bit that leaks into foreground pixels for fonts wider than 15 pixels, so the two can be swapped freely.
+ * Colors with higher bits set are stored as they are here, but may not decode correctly through the interpolator.
+ * This matches text_mode_cells_kernel, so it can be passed to text_mode_generate_line_runs().
+ * @param write Write pointer; may be at any halfword
+ * @param cells First cell to render
+ * @param count Number of cells to render
+ * @param font_row Scan line of glyph 0 to render, from text_mode_font_row()
+ * @param font Pointer to font to use for rendering
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @param colors Colors of every cell, from text_buffer_row_colors(); ignored unless TEXT_MODE_GLYPH_ONLY_CELLS is set
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_lut_generate_cells(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors);
+
+/**
+ * Same as text_mode_generate_line(), but renders with text_mode_lut_generate_cells(),
+ * so the interpolator is left free for other uses.
+ * @param write Write pointer
+ * @param scanline Scanline number
+ * @param screen Pointer to text_buffer with page of text to display
+ * @param font Pointer to font to use for rendering
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_lut_generate_line(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette);
+
+#endif /* TEXT_MODE_LUT_H */
@@ -0,0 +1,32 @@
+#include "text_mode_overlay.h"
+
+
+void __not_in_flash_func(text_mode_overlay_merge)(uint16_t* line, const uint16_t* end,
+    const text_mode_overlay* overlay, const uint16_t* pixels, const uint16_t* pixels_end)
+{
+    int x = overlay->position.x;
+    if (x < 0) {
+        pixels -= x;
+        x = 0;
+    }
+    if (x >= end - line)
+        return;
+    uint16_t* write = line + x;
+    if (pixels_end - pixels > end - write)
+        pixels_end = pixels + (end - write);
+    // Transparent spans are usually long, so skip them two pixels to a word when the line allows it.
+    if (!((uintptr_t)pixels & 2) && pixels < pixels_end - 1) {
+        for (; pixels < pixels_end - 1; pixels += 2, write += 2) {
+            uint32_t pair = *(const uint32_t*)pixels;
+            if ((pair & (TEXT_MODE_TRANSPARENT * 0x10001u)) == TEXT_MODE_TRANSPARENT * 0x10001u)
+                continue;
+            if (!(pair & TEXT_MODE_TRANSPARENT))
+                write[0] = pair;
+            if (!(pair & (TEXT_MODE_TRANSPARENT << 16)))
+                write[1] = pair >> 16;
+        }
+    }
+    for (; pixels < pixels_end; pixels++, write++)
+        if (!(*pixels & TEXT_MODE_TRANSPARENT))
+            *write = *pixels;
+}
@@ -0,0 +1,96 @@
+#ifndef TEXT_MODE_OVERLAY_H
+#define TEXT_MODE_OVERLAY_H
+#include "text_mode_clip.h"
+
+/**
+ * Bit of a pixel value that makes it transparent in an overlay, which is scanvideo's alpha bit in RGB555.
+ * Give an overlay's cells a background color with this bit set, or in palettized mode a palette entry with it set,
+ * and the layer below shows through everywhere but the glyphs.
+ * This takes all 16 bits of color (see TEXT_MODE_COLOR_BITS), since fonts wider than 15 pixels otherwise leak
+ * this bit into every foreground pixel, so it needs TEXT_MODE_MAX_FONT_WIDTH of 15 or less, or TEXT_MODE_SPLIT_DECODE.
+ */
+#define TEXT_MODE_TRANSPARENT 0x8000u
+
+#ifndef TEXT_MODE_OVERLAY_MAX_PIXELS
+/**
+ * Widest an overlay's view can be, in pixels, which sets the size of the scratch line it's rendered into.
+ * Wider overlays aren't drawn.
+ */
+#define TEXT_MODE_OVERLAY_MAX_PIXELS 640
+#endif
+
+/**
+ * A second text buffer drawn over the screen, such as a popup, menu, or status line,
+ * so nothing under it has to be saved and restored.
+ * Each scan line it covers is rendered by the usual line generator into a scratch line,
+ * and then every pixel that isn't TEXT_MODE_TRANSPARENT is stored over the line below.
+ * This is read once per scan line, so it can be moved or switched at any time.
+ */
+typedef struct text_mode_overlay
+{
+    /** Text to draw; its view, line spacing, and row sizes work the same as on the main buffer. */
+    text_buffer* buffer;
+    /** Screen position of the top left pixel of the buffer's view, which may be partly off screen. */
+    coord position;
+} text_mode_overlay;
+
+/**
+ * Returns the number of scan lines the overlay covers, which is every scan line of its buffer.
+ */
+static inline unsigned text_mode_overlay_lines(const text_mode_overlay* overlay, const text_mode_font* font)
+{
+    return text_mode_buffer_lines(overlay->buffer, font);
+}
+
+/**
+ * Returns true if a scan line of the screen shows any of the overlay.
+ * The render loop uses this to send the line as one raw run that the overlay can be drawn into.
+ * Always false without TEXT_MODE_OVERLAY, so the check compiles away.
+ * @param overlay Overlay to draw, or NULL for none
+ * @param scanline Scanline number
+ */
+static inline bool text_mode_overlay_on_line(const text_mode_overlay* overlay, unsigned scanline,
+    const text_mode_font* font)
+{
+#if TEXT_MODE_OVERLAY
+    // An overlay above the line wraps around to a huge line number.
+    return overlay && scanline - overlay->position.y < text_mode_overlay_lines(overlay, font);
+#else
+    (void)overlay;
+    (void)scanline;
+    (void)font;
+    return false;
+#endif
+}
+
+/**
+ * Returns the scan line of the overlay's buffer to render for a scan line of the screen it covers,
+ * to pass to the line generator.
+ */
+static inline unsigned text_mode_overlay_scanline(const text_mode_overlay* overlay, unsigned scanline)
+{
+    return scanline - overlay->position.y;
+}
+
+/**
+ * Returns true if the overlay's view is narrow enough to render into a scratch line of
+ * TEXT_MODE_OVERLAY_MAX_PIXELS.
+ */
+static inline bool text_mode_overlay_fits(const text_mode_overlay* overlay, const text_mode_font* font)
+{
+    text_mode_clip clip = text_mode_clip_view(overlay->buffer, font);
+    return text_mode_clip_pixels(&clip) <= TEXT_MODE_OVERLAY_MAX_PIXELS;
+}
+
+/**
+ * Stores a rendered line of the overlay over a scan line, except for pixels with TEXT_MODE_TRANSPARENT set,
+ * clipped to the edges of the scan line.
+ * @param line First pixel of the scan line, which is the screen's leftmost pixel
+ * @param end End of the scan line's pixels; nothing is stored past it
+ * @param pixels Line of the overlay from the line generator, for text_mode_overlay_scanline()
+ * @param pixels_end End of the overlay's pixels
+ */
+void text_mode_overlay_merge(uint16_t* line, const uint16_t* end, const text_mode_overlay* overlay,
+    const uint16_t* pixels, const uint16_t* pixels_end);
+
+#endif /* TEXT_MODE_OVERLAY_H */
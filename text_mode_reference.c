@@ -0,0 +1,105 @@
+#include "text_mode_reference.h"
+#include "text_mode_clip.h"
+#include "text_mode_bitmap.h"
+#include "text_mode_tile.h"
+
+
+/**
+ * Internal routine: Converts a cell color into a 16-bit pixel value.
+ */
+static inline uint16_t text_mode_reference_color(text_color color, const uint16_t* palette)
+{
+#if TEXT_MODE_PALETTIZED_COLOR
+    return palette[color];
+#else
+    (void)palette;
+    return color;
+#endif
+}
+
+
+uint16_t* text_mode_reference_generate_line(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette)
+{
+    text_row_line at = text_mode_locate_line(screen, font, text_mode_view_line(screen, font, scanline));
+    unsigned row = at.row;
+    unsigned char_row = at.line;
+    font = text_mode_row_font(screen, font, row);
+    text_mode_clip clip = text_mode_clip_view_row(screen, font, row);
+    if (char_row >= font->scan_lines)
+        return text_mode_clip_generate_spacing(write, text_buffer_cell(screen, 0, row), &clip, font, palette,
+            text_buffer_row_colors(screen, row));
+    const void* font_row = text_mode_font_row(font, text_mode_glyph_line(screen, font, row, char_row));
+    if (text_buffer_row_size(screen, row))
+        return text_mode_clip_generate_double(write, text_buffer_cell(screen, 0, row), &clip, font_row, font, palette,
+            text_buffer_row_colors(screen, row), text_mode_reference_generate_cells);
+    const text_mode_tiles* tiles = text_mode_row_tiles(screen, row);
+    if (tiles)
+        return text_mode_tile_generate_line(write, text_buffer_cell(screen, 0, row), &clip, tiles, char_row, font,
+            text_buffer_row_colors(screen, row));
+    if (text_mode_bitmap_on_row(screen, row))
+        return text_mode_bitmap_generate_cells(write, screen, row, char_row, &clip, font_row, font, palette,
+            text_buffer_row_colors(screen, row), text_mode_reference_generate_cells);
+    return text_mode_clip_generate_cells(write, text_buffer_cell(screen, 0, row), &clip, font_row, font, palette,
+        text_buffer_row_colors(screen, row), text_mode_reference_generate_cells);
+}
+
+
+uint16_t* text_mode_reference_generate_cells(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors)
+{
+    const unsigned char* data = font_row;
+    unsigned pixels = font->scan_pixels;
+    for (const text_cell* cell = cells; count > 0; count--, cell++) {
+        // Only the low 16 bits of BASE1 get stored, which is where the embiggener leaks through.
+        color_pair cell_colors = text_cell_colors(cell, colors);
+        uint16_t foreground = text_mode_reference_color(cell_colors.foreground, palette) + TEXT_MODE_EMBIGGENER;
+        uint16_t background = text_mode_reference_color(cell_colors.background, palette);
+        uint32_t bits = text_mode_font_bits(font, data + cell->glyph * font->bytes_per_glyph);
+        // The leftmost pixel is the most significant bit.
+        for (unsigned bit = pixels; bit > 0; bit--)
+            *write++ = (bits >> (bit - 1)) & 1 ? foreground : background;
+    }
+    return write;
+}
+
+
+uint16_t* text_mode_reference_generate_line_pair(uint16_t* write0, uint16_t* write1, unsigned scanline,
+    text_buffer* screen, const text_mode_font* font, const uint16_t* palette)
+{
+    text_row_line at = text_mode_locate_line(screen, font, text_mode_view_line(screen, font, scanline));
+    unsigned row = at.row;
+    // Double size rows don't show consecutive glyph lines side by side, so their lines are done one at a time,
+    // and so are tile rows and rows with bitmap regions.
+    if (text_buffer_row_size(screen, row) || text_mode_row_tiles(screen, row) || text_mode_bitmap_on_row(screen, row)) {
+        text_mode_reference_generate_line(write1, scanline + 1, screen, font, palette);
+        return text_mode_reference_generate_line(write0, scanline, screen, font, palette);
+    }
+    font = text_mode_row_font(screen, font, row);
+    text_mode_clip clip = text_mode_clip_view(screen, font);
+    return text_mode_clip_generate_cells_pair(write0, write1, text_buffer_cell(screen, 0, row), &clip,
+        text_mode_font_row(font, at.line), font, palette, text_buffer_row_colors(screen, row),
+        text_mode_reference_generate_cells_pair);
+}
+
+
+uint16_t* text_mode_reference_generate_cells_pair(uint16_t* write0, uint16_t* write1, const text_cell* cells,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors)
+{
+    const unsigned char* data0 = font_row;
+    const unsigned char* data1 = data0 + font->scan_line_stride;
+    unsigned pixels = font->scan_pixels;
+    for (const text_cell* cell = cells; count > 0; count--, cell++) {
+        color_pair cell_colors = text_cell_colors(cell, colors);
+        uint16_t foreground = text_mode_reference_color(cell_colors.foreground, palette) + TEXT_MODE_EMBIGGENER;
+        uint16_t background = text_mode_reference_color(cell_colors.background, palette);
+        size_t offset = cell->glyph * font->bytes_per_glyph;
+        uint32_t bits0 = text_mode_font_bits(font, data0 + offset);
+        uint32_t bits1 = text_mode_font_bits(font, data1 + offset);
+        for (unsigned bit = pixels; bit > 0; bit--) {
+            *write0++ = (bits0 >> (bit - 1)) & 1 ? foreground : background;
+            *write1++ = (bits1 >> (bit - 1)) & 1 ? foreground : background;
+        }
+    }
+    return write0;
+}
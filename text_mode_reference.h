@@ -0,0 +1,66 @@
+#ifndef TEXT_MODE_REFERENCE_H
+#define TEXT_MODE_REFERENCE_H
+#include "text_buffer.h"
+#include "text_mode_font.h"
+
+/**
+ * Portable C version of text_mode_generate_line().
+ * This models the pixels the assembly routine is meant to produce, including the embiggener bit that
+ * leaks into foreground pixels for fonts wider than 15 pixels, but does not need the interpolator.
+ * host/interp_fuzz.c checks it against a model of the interpolator running the decoder's register sequence;
+ * nothing here runs the assembly itself.
+ * It is much slower, so it is meant for testing, benchmarking, and running the text stack off-device.
+ * @param write Write pointer
+ * @param scanline Scanline number
+ * @param screen Pointer to text_buffer with page of text to display
+ * @param font Pointer to font to use for rendering
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_reference_generate_line(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette);
+
+/**
+ * Portable C version of text_mode_generate_cells().
+ * @param write Write pointer
+ * @param cells First cell to render
+ * @param count Number of cells to render
+ * @param font_row Scan line of glyph 0 to render, from text_mode_font_row()
+ * @param font Pointer to font to use for rendering
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @param colors Colors of every cell, from text_buffer_row_colors(); ignored unless TEXT_MODE_GLYPH_ONLY_CELLS is set
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_reference_generate_cells(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors);
+
+/**
+ * Portable C version of text_mode_generate_line_pair().
+ * @param write0 Write pointer for the first line
+ * @param write1 Write pointer for the second line
+ * @param scanline Scanline number of the first line, which must not show the last glyph line of a text row
+ *        or a spacing line once the buffer's view is applied (see text_mode_view_line())
+ * @param screen Pointer to text_buffer with page of text to display
+ * @param font Pointer to font to use for rendering
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @return Returns modified write0
+ */
+uint16_t* text_mode_reference_generate_line_pair(uint16_t* write0, uint16_t* write1, unsigned scanline,
+    text_buffer* screen, const text_mode_font* font, const uint16_t* palette);
+
+/**
+ * Portable C version of text_mode_generate_cells_pair().
+ * @param write0 Write pointer for the first line
+ * @param write1 Write pointer for the second line
+ * @param cells First cell to render
+ * @param count Number of cells to render
+ * @param font_row Scan line of glyph 0 to render on the first line; the second line uses the next one
+ * @param font Pointer to font to use for rendering
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @param colors Colors of every cell, from text_buffer_row_colors(); ignored unless TEXT_MODE_GLYPH_ONLY_CELLS is set
+ * @return Returns modified write0
+ */
+uint16_t* text_mode_reference_generate_cells_pair(uint16_t* write0, uint16_t* write1, const text_cell* cells,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors);
+
+#endif /* TEXT_MODE_REFERENCE_H */
@@ -0,0 +1,137 @@
+#include "text_mode_repeat.h"
+#include "text_mode_style.h"
+#include <string.h>
+
+
+/**
+ * Internal routine: Returns true if two cells are drawn exactly the same way.
+ */
+static inline bool text_mode_repeat_same(const text_cell* a, const text_cell* b)
+{
+    return a->glyph == b->glyph
+#if !TEXT_MODE_GLYPH_ONLY_CELLS
+        && a->foreground == b->foreground && a->background == b->background
+#endif
+        && text_cell_style(a) == text_cell_style(b);
+}
+
+
+/**
+ * Internal routine: Returns the end of the run of cells identical to the first one.
+ */
+static inline const text_cell* text_mode_repeat_run(const text_cell* cell, const text_cell* end)
+{
+    const text_cell* run = cell + 1;
+    while (run < end && text_mode_repeat_same(cell, run))
+        run++;
+    return run;
+}
+
+
+/**
+ * Internal routine: Runs a kernel over some cells, through text_mode_style_generate_cells() if cells can be styled.
+ */
+static inline uint16_t* text_mode_repeat_kernel(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel)
+{
+#if TEXT_MODE_CELL_STYLES
+    return text_mode_style_generate_cells(write, cells, count, font_row, font, palette, colors, kernel);
+#else
+    return kernel(write, cells, count, font_row, font, palette, colors);
+#endif
+}
+
+
+/**
+ * Internal routine: Two-line version of text_mode_repeat_kernel().
+ */
+static inline uint16_t* text_mode_repeat_pair_kernel(uint16_t* write0, uint16_t* write1, const text_cell* cells,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_pair_kernel kernel)
+{
+#if TEXT_MODE_CELL_STYLES
+    return text_mode_style_generate_cells_pair(write0, write1, cells, count, font_row, font, palette, colors,
+        kernel);
+#else
+    return kernel(write0, write1, cells, count, font_row, font, palette, colors);
+#endif
+}
+
+
+/**
+ * Internal routine: Repeats the last cell's pixels before write until count more pixels have been stored.
+ * Each copy doubles what is there to copy from, so a long run only takes a few copies, and memcpy() can
+ * move them a word at a time once the distance between the copies is a whole number of words.
+ * @param pixels Width of the cell
+ */
+static inline uint16_t* text_mode_repeat_pixels(uint16_t* write, unsigned pixels, unsigned count)
+{
+    const uint16_t* start = write - pixels;
+    while (count) {
+        unsigned done = write - start;
+        unsigned copy = count < done ? count : done;
+        memcpy(write, start, copy * sizeof(uint16_t));
+        write += copy;
+        count -= copy;
+    }
+    return write;
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_repeat_generate_cells)(uint16_t* write, const text_cell* cells,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel)
+{
+    const text_cell* end = cells + count;
+    const text_cell* raw = cells;
+    unsigned pixels = font->scan_pixels;
+    for (const text_cell* cell = cells; cell + 1 < end;) {
+        if (!text_mode_repeat_same(cell, cell + 1)) {
+            cell++;
+            continue;
+        }
+        const text_cell* run = text_mode_repeat_run(cell, end);
+        if (run - cell >= TEXT_MODE_REPEAT_MIN_CELLS) {
+            // The first cell of the run goes with the cells before it, so there's something to copy.
+            write = text_mode_repeat_kernel(write, raw, cell + 1 - raw, font_row, font, palette, colors, kernel);
+            write = text_mode_repeat_pixels(write, pixels, (run - cell - 1) * pixels);
+            raw = run;
+        }
+        cell = run;
+    }
+    if (raw != end)
+        write = text_mode_repeat_kernel(write, raw, end - raw, font_row, font, palette, colors, kernel);
+    return write;
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_repeat_generate_cells_pair)(uint16_t* write0, uint16_t* write1,
+    const text_cell* cells, unsigned count, const void* font_row, const text_mode_font* font,
+    const uint16_t* palette, color_pair colors, text_mode_cells_pair_kernel kernel)
+{
+    const text_cell* end = cells + count;
+    const text_cell* raw = cells;
+    unsigned pixels = font->scan_pixels;
+    for (const text_cell* cell = cells; cell + 1 < end;) {
+        if (!text_mode_repeat_same(cell, cell + 1)) {
+            cell++;
+            continue;
+        }
+        const text_cell* run = text_mode_repeat_run(cell, end);
+        if (run - cell >= TEXT_MODE_REPEAT_MIN_CELLS) {
+            uint16_t* next = text_mode_repeat_pair_kernel(write0, write1, raw, cell + 1 - raw, font_row, font,
+                palette, colors, kernel);
+            write1 += next - write0;
+            unsigned copies = (run - cell - 1) * pixels;
+            write0 = text_mode_repeat_pixels(next, pixels, copies);
+            write1 = text_mode_repeat_pixels(write1, pixels, copies);
+            raw = run;
+        }
+        cell = run;
+    }
+    if (raw != end)
+        write0 = text_mode_repeat_pair_kernel(write0, write1, raw, end - raw, font_row, font, palette, colors,
+            kernel);
+    return write0;
+}
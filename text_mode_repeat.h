@@ -0,0 +1,38 @@
+#ifndef TEXT_MODE_REPEAT_H
+#define TEXT_MODE_REPEAT_H
+#include "text_mode_kernel.h"
+
+#ifndef TEXT_MODE_REPEAT_MIN_CELLS
+/**
+ * Shortest run of identical cells worth copying instead of rendering, counting the first one,
+ * which is always rendered.
+ * Each run splits the kernel call around it, so runs shorter than this, like the double letters and
+ * spaces of prose, are cheaper to just render.
+ */
+#define TEXT_MODE_REPEAT_MIN_CELLS 4
+#endif
+
+/**
+ * Renders one scan line of a span of cells, copying the pixels of runs of identical cells instead of
+ * rendering every one of them, for box drawing rules, progress bars, and blank stretches of a row.
+ * The first cell of each run is rendered by kernel, and the rest of the run is filled by copying
+ * what has been stored so far, so the copies get longer as the run does and go a word at a time.
+ * Spans between runs go to kernel unchanged, so text without runs costs one extra compare per cell.
+ * The output is the same as kernel's.
+ * The parameters are the same as text_mode_cells_kernel's, plus the kernel to use.
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_repeat_generate_cells(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel);
+
+/**
+ * Two-line version of text_mode_repeat_generate_cells().
+ * The parameters are the same as text_mode_cells_pair_kernel's, plus the kernel to use.
+ * @return Returns modified write0; write1 advances the same amount
+ */
+uint16_t* text_mode_repeat_generate_cells_pair(uint16_t* write0, uint16_t* write1, const text_cell* cells,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_pair_kernel kernel);
+
+#endif /* TEXT_MODE_REPEAT_H */
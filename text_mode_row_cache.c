@@ -0,0 +1,66 @@
+#include "text_mode_row_cache.h"
+
+
+bool __not_in_flash_func(text_mode_row_cache_update)(text_mode_row_cache* self, text_buffer* screen,
+    unsigned scanline, int row, coord_x col, coord_x cols, const text_mode_font* font, const uint16_t* palette)
+{
+    // Nothing checks the cells themselves, so each frame starts over, or a row shown at the bottom of one frame
+    // and the top of the next would never pick up changes.
+    if (scanline <= self->scanline)
+        text_mode_row_cache_invalidate(self);
+    self->scanline = scanline;
+    if (cols > TEXT_MODE_ROW_CACHE_MAX_COLS || cols <= 0) {
+        text_mode_row_cache_invalidate(self);
+        return false;
+    }
+#if !TEXT_MODE_PALETTIZED_COLOR
+    palette = NULL;
+#endif
+    if (self->row == row && self->col == col && self->cols == cols && self->screen == screen && self->font == font
+        && self->palette == palette)
+        return !self->styled;
+    const text_cell* cell = text_buffer_cell(screen, col, row);
+    text_mode_cached_cell* cached = self->cells;
+    unsigned bytes_per_glyph = font->bytes_per_glyph;
+    color_pair row_colors = text_buffer_row_colors(screen, row);
+    self->styled = false;
+    for (coord_x i = cols; i > 0; i--, cell++, cached++) {
+        if (text_cell_style(cell)) {
+            self->styled = true;
+            break;
+        }
+        color_pair colors = text_cell_colors(cell, row_colors);
+#if TEXT_MODE_PALETTIZED_COLOR
+        cached->base1 = palette[colors.foreground] + TEXT_MODE_EMBIGGENER;
+        cached->base0 = palette[colors.background];
+#else
+        cached->base1 = colors.foreground + TEXT_MODE_EMBIGGENER;
+        cached->base0 = colors.background;
+#endif
+        cached->glyph_offset = cell->glyph * bytes_per_glyph;
+    }
+    self->screen = screen;
+    self->font = font;
+    self->palette = palette;
+    self->row = row;
+    self->col = col;
+    self->cols = cols;
+    return !self->styled;
+}
+
+
+uint16_t* text_mode_row_cache_generate_line(uint16_t* write, const text_mode_row_cache* self, unsigned char_row)
+{
+    const text_mode_font* font = self->font;
+    const unsigned char* data = text_mode_font_row(font, char_row);
+    unsigned pixels = font->scan_pixels;
+    const text_mode_cached_cell* cached = self->cells;
+    for (coord_x col = self->cols; col > 0; col--, cached++) {
+        uint16_t foreground = cached->base1;
+        uint16_t background = cached->base0;
+        uint32_t bits = text_mode_font_bits(font, data + cached->glyph_offset);
+        for (unsigned bit = pixels; bit > 0; bit--)
+            *write++ = (bits >> (bit - 1)) & 1 ? foreground : background;
+    }
+    return write;
+}
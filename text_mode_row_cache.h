@@ -0,0 +1,87 @@
+#ifndef TEXT_MODE_ROW_CACHE_H
+#define TEXT_MODE_ROW_CACHE_H
+#include "text_buffer.h"
+#include "text_mode_font.h"
+
+#ifndef TEXT_MODE_ROW_CACHE_MAX_COLS
+/**
+ * Widest row the row cache can hold.
+ * Each column costs 12 bytes, so the default is a little over 1.5 K.
+ * The render core's cache lives in the 4 K scratch X bank, which it shares with core 1's 2 K stack,
+ * and text_mode.c fails to build if it doesn't fit.
+ */
+#define TEXT_MODE_ROW_CACHE_MAX_COLS 128
+#endif
+
+/**
+ * A text cell resolved into exactly what the scan line generator stores into the interpolator.
+ * The field order matters: the assembly routine loads all three with a single ldmia.
+ */
+typedef struct text_mode_cached_cell
+{
+    /** Foreground color with the embiggener added, ready for BASE1. */
+    uint32_t base1;
+    /** Background color, ready for BASE0. */
+    uint32_t base0;
+    /** Byte offset of the glyph's bitmap in the font data. */
+    uint32_t glyph_offset;
+} text_mode_cached_cell;
+
+/**
+ * One text row, resolved once at its first scan line and reused for the rest of its scan lines.
+ * This avoids re-reading the text buffer and redoing the glyph multiply, palette lookups,
+ * and embiggener addition on every scan line of the row.
+ */
+typedef struct text_mode_row_cache
+{
+    /** Buffer the cached row came from. */
+    const text_buffer* screen;
+    /** Font the glyph offsets were computed for. */
+    const text_mode_font* font;
+    /** Palette the colors were decoded with. */
+    const uint16_t* palette;
+    /** Text row that is cached, or -1 if nothing is. */
+    int row;
+    /** Scan line of the last update; one that isn't past it starts a new frame. */
+    unsigned scanline;
+    /** Column of the first cached cell. */
+    coord_x col;
+    /** Number of valid entries in cells. */
+    coord_x cols;
+    /** True if the row has cells with text_style bits, which can't be cached, so cells is not filled in. */
+    bool styled;
+    /** Resolved cells */
+    text_mode_cached_cell cells[TEXT_MODE_ROW_CACHE_MAX_COLS];
+} text_mode_row_cache;
+
+/**
+ * Marks a row cache as empty, so the next update always refills it.
+ */
+static inline void text_mode_row_cache_invalidate(text_mode_row_cache* self)
+{
+    self->row = -1;
+}
+
+/**
+ * Makes sure the cache holds a span of a given text row, refilling it if the row, span, buffer, font,
+ * or palette changed, or a new frame started.
+ * Changes to cells of a row that is already cached do not show up until the row is refilled, so at the latest
+ * in the next frame, even if the same row is the last of one frame and the first of the next.
+ * @param scanline Scan line being rendered; one that isn't past the last update's starts a new frame
+ * @param col First column to cache, normally the col of the buffer's text_mode_clip
+ * @param cols Number of cells to cache
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @return false if the span is too wide to cache, empty, or has styled cells, in which case nothing is cached.
+ */
+bool text_mode_row_cache_update(text_mode_row_cache* self, text_buffer* screen, unsigned scanline, int row,
+    coord_x col, coord_x cols, const text_mode_font* font, const uint16_t* palette);
+
+/**
+ * Portable C version of the row-cached scan line generator.
+ * @param write Write pointer
+ * @param char_row Scan line within the cached text row
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_row_cache_generate_line(uint16_t* write, const text_mode_row_cache* self, unsigned char_row);
+
+#endif /* TEXT_MODE_ROW_CACHE_H */
@@ -0,0 +1,50 @@
+#include "text_mode_row_map.h"
+
+
+#if TEXT_MODE_ROW_FONTS
+unsigned text_mode_row_map_lines(const text_buffer* screen, const text_mode_font* font)
+{
+    unsigned lines = 0;
+    for (coord_y row = 0; row < screen->size.y; row++)
+        lines += text_mode_row_pitch(screen, text_mode_row_font(screen, font, row));
+    return lines;
+}
+
+
+bool text_mode_row_map_update(text_buffer* screen, const text_mode_font* font, coord_y first_row)
+{
+    unsigned line = 0;
+    for (coord_y row = 0; row < first_row; row++)
+        line += text_mode_row_pitch(screen, text_mode_row_font(screen, font, row));
+    text_row_line* entry = screen->line_map + line;
+    const text_row_line* end = screen->line_map + screen->line_map_capacity;
+    for (coord_y row = first_row; row < screen->size.y; row++) {
+        unsigned pitch = text_mode_row_pitch(screen, text_mode_row_font(screen, font, row));
+        for (unsigned i = 0; i < pitch; i++, entry++) {
+            if (entry >= end) {
+                // The rows that don't fit are cut off the bottom of the buffer.
+                screen->line_map_lines = screen->line_map_capacity;
+                return false;
+            }
+            entry->row = row;
+            entry->line = i;
+        }
+    }
+    screen->line_map_lines = entry - screen->line_map;
+    return true;
+}
+
+
+bool text_mode_row_map_set_font(text_buffer* screen, const text_mode_font* font, coord_y row,
+    const text_mode_font* row_font)
+{
+    unsigned old_pitch = text_mode_row_pitch(screen, text_mode_row_font(screen, font, row));
+    unsigned new_pitch = text_mode_row_pitch(screen, row_font ? row_font : font);
+    if (new_pitch > old_pitch && screen->line_map_lines + (new_pitch - old_pitch) > screen->line_map_capacity)
+        return false;
+    screen->row_fonts[row] = row_font;
+    if (new_pitch != old_pitch)
+        return text_mode_row_map_update(screen, font, row);
+    return true;
+}
+#endif
@@ -0,0 +1,39 @@
+#ifndef TEXT_MODE_ROW_MAP_H
+#define TEXT_MODE_ROW_MAP_H
+#include "text_mode_clip.h"
+
+#if TEXT_MODE_ROW_FONTS
+/**
+ * Returns the number of entries a buffer's line map needs, which is its height in scan lines
+ * with every row drawn in its own font.
+ * @param font Font the buffer is rendered with
+ */
+unsigned text_mode_row_map_lines(const text_buffer* screen, const text_mode_font* font);
+
+/**
+ * Rebuilds a buffer's line map (see text_buffer.line_map) from a row down to the bottom of the buffer.
+ * Rows above first_row must not have changed height since the map was last built, so after changing the
+ * buffer's line spacing, or the font it's rendered with, start from row 0.
+ * The scan line generators read the map without any synchronization, so a frame being rendered while it's
+ * rebuilt may show rows in the wrong place for a few lines, but never reads outside the buffer.
+ * Nothing is written past line_map_capacity entries; rows that don't fit are cut off the bottom of the buffer.
+ * @param font Font the buffer is rendered with
+ * @param first_row First row whose height may have changed
+ * @return Returns false if the map was cut short
+ */
+bool text_mode_row_map_update(text_buffer* screen, const text_mode_font* font, coord_y first_row);
+
+/**
+ * Sets the font of a row, and updates the buffer's line map if that changes the row's height.
+ * Fonts of the same height just swap over, so this is cheap for switching between fonts of one size.
+ * The buffer must have row_fonts and line_map.
+ * @param font Font the buffer is rendered with
+ * @param row Row to change
+ * @param row_font Font to draw the row in, or NULL for font
+ * @return Returns false, leaving the row's font alone, if the taller row doesn't fit in line_map_capacity
+ */
+bool text_mode_row_map_set_font(text_buffer* screen, const text_mode_font* font, coord_y row,
+    const text_mode_font* row_font);
+#endif
+
+#endif /* TEXT_MODE_ROW_MAP_H */
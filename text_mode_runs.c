@@ -0,0 +1,167 @@
+#include "text_mode_runs.h"
+#include "text_mode_composable.h"
+#include "text_mode_clip.h"
+#include "text_mode_style.h"
+#include "text_mode_repeat.h"
+#include "text_mode_bitmap.h"
+#include "text_mode_tile.h"
+
+
+/**
+ * Internal routine: Renders a span of cells as a raw run.
+ */
+static inline uint16_t* text_mode_runs_raw(uint16_t* write, const text_cell* start, const text_cell* end,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel)
+{
+    if (start == end)
+        return write;
+#if TEXT_MODE_REPEAT_CELLS
+    uint16_t* pixels = text_mode_repeat_generate_cells(text_mode_begin_raw_run(write), start, end - start, font_row,
+        font, palette, colors, kernel);
+#elif TEXT_MODE_CELL_STYLES
+    uint16_t* pixels = text_mode_style_generate_cells(text_mode_begin_raw_run(write), start, end - start, font_row,
+        font, palette, colors, kernel);
+#else
+    uint16_t* pixels = kernel(text_mode_begin_raw_run(write), start, end - start, font_row, font, palette, colors);
+#endif
+    return text_mode_end_raw_run(write, pixels);
+}
+
+
+/**
+ * Internal routine: Renders part of a cell that is cut off by the view as a raw run.
+ */
+static inline uint16_t* text_mode_runs_cut(uint16_t* write, const text_cell* cell, unsigned first, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel)
+{
+    uint16_t* pixels = text_mode_clip_generate_cell(text_mode_begin_raw_run(write), cell, first, count, font_row,
+        font, palette, colors, kernel);
+    return text_mode_end_raw_run(write, pixels);
+}
+
+
+/**
+ * Internal routine: Writes a span of a cell color, as a color run if it's long enough for one.
+ */
+static inline uint16_t* text_mode_runs_fill(uint16_t* write, text_color color, unsigned count, const uint16_t* palette)
+{
+#if TEXT_MODE_PALETTIZED_COLOR
+    uint16_t pixel = palette[color];
+#else
+    (void)palette;
+    uint16_t pixel = color;
+#endif
+    if (count >= 3)
+        return text_mode_color_run(write, pixel, count);
+    uint16_t* pixels = text_mode_begin_raw_run(write);
+    for (; count > 0; count--)
+        *pixels++ = pixel;
+    return text_mode_end_raw_run(write, pixels);
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_generate_spacing_line)(uint16_t* write, text_buffer* screen,
+    const text_mode_font* font, unsigned row, const uint16_t* palette)
+{
+    font = text_mode_row_font(screen, font, row);
+    text_mode_clip clip = text_mode_clip_view_row(screen, font, row);
+    const text_cell* whole = text_buffer_cell(screen, clip.col, row);
+    const text_cell* cell = whole - (clip.head ? 1 : 0);
+    const text_cell* end = whole + clip.cols + (clip.tail ? 1 : 0);
+    color_pair colors = text_buffer_row_colors(screen, row);
+    text_color background = 0;
+    unsigned count = 0;
+    for (; cell < end; cell++) {
+        text_color next = text_mode_style_colors(cell, colors).background;
+        if (count && next != background) {
+            write = text_mode_runs_fill(write, background, count, palette);
+            count = 0;
+        }
+        background = next;
+        if (cell < whole)
+            count += clip.head;
+        else if (cell == whole + clip.cols)
+            count += clip.tail;
+        else
+            count += clip.pixels;
+    }
+    return count ? text_mode_runs_fill(write, background, count, palette) : write;
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_generate_line_runs)(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette, text_mode_cells_kernel kernel)
+{
+    text_row_line at = text_mode_locate_line(screen, font, text_mode_view_line(screen, font, scanline));
+    unsigned char_row = at.line;
+    unsigned row = at.row;
+    font = text_mode_row_font(screen, font, row);
+    if (char_row >= font->scan_lines)
+        return text_mode_generate_spacing_line(write, screen, font, row, palette);
+    text_mode_clip clip = text_mode_clip_view_row(screen, font, row);
+    const text_cell* cell = text_buffer_cell(screen, clip.col, row);
+    color_pair colors = text_buffer_row_colors(screen, row);
+    const text_cell* end = cell + clip.cols;
+    const void* font_row = text_mode_font_row(font, text_mode_glyph_line(screen, font, row, char_row));
+    // Double size rows are rare enough that they just go in one raw run.
+    if (text_buffer_row_size(screen, row)) {
+        uint16_t* pixels = text_mode_clip_generate_double(text_mode_begin_raw_run(write), cell - clip.col, &clip,
+            font_row, font, palette, colors, kernel);
+        return text_mode_end_raw_run(write, pixels);
+    }
+    // So do tile rows and rows with bitmap regions, whose pixels aren't blank runs of cells.
+    const text_mode_tiles* tiles = text_mode_row_tiles(screen, row);
+    if (tiles) {
+        uint16_t* pixels = text_mode_tile_generate_line(text_mode_begin_raw_run(write), cell - clip.col, &clip,
+            tiles, char_row, font, colors);
+        return text_mode_end_raw_run(write, pixels);
+    }
+    if (text_mode_bitmap_on_row(screen, row)) {
+        uint16_t* pixels = text_mode_bitmap_generate_cells(text_mode_begin_raw_run(write), screen, row, char_row,
+            &clip, font_row, font, palette, colors, kernel);
+        return text_mode_end_raw_run(write, pixels);
+    }
+    if (!font->blank_rows || char_row >= 32) {
+        uint16_t* pixels = text_mode_clip_generate_cells(text_mode_begin_raw_run(write), cell - clip.col, &clip,
+            font_row, font, palette, colors, kernel);
+        return text_mode_end_raw_run(write, pixels);
+    }
+    // Cells cut off by the view go in raw runs of their own, which is simpler than splicing them into
+    // whatever is next to them, and only costs a token at each edge of a scrolled view.
+    if (clip.head)
+        write = text_mode_runs_cut(write, cell - 1, clip.skip, clip.head, font_row, font, palette, colors, kernel);
+    const uint32_t* blank_rows = font->blank_rows;
+    uint32_t bit = 1u << char_row;
+    // Underlined or struck out cells aren't blank on their line, whatever their glyph is.
+    unsigned line_mask = text_mode_style_line_mask(font, char_row);
+    unsigned pixels = font->scan_pixels;
+    const text_cell* raw = cell;
+    while (cell < end) {
+        if (!(blank_rows[cell->glyph] & bit) || text_cell_style(cell) & line_mask) {
+            cell++;
+            continue;
+        }
+        text_color background = text_mode_style_colors(cell, colors).background;
+        const text_cell* run = cell;
+        while (run < end && blank_rows[run->glyph] & bit && !(text_cell_style(run) & line_mask)
+            && text_mode_style_colors(run, colors).background == background)
+            run++;
+        unsigned count = (run - cell) * pixels;
+        if (count >= TEXT_MODE_BLANK_RUN_MIN_PIXELS && count >= 3) {
+            write = text_mode_runs_raw(write, raw, cell, font_row, font, palette, colors, kernel);
+#if TEXT_MODE_PALETTIZED_COLOR
+            write = text_mode_color_run(write, palette[background], count);
+#else
+            write = text_mode_color_run(write, background, count);
+#endif
+            raw = run;
+        }
+        cell = run;
+    }
+    write = text_mode_runs_raw(write, raw, end, font_row, font, palette, colors, kernel);
+    if (clip.tail)
+        write = text_mode_runs_cut(write, end, 0, clip.tail, font_row, font, palette, colors, kernel);
+    return write;
+}
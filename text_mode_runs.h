@@ -0,0 +1,48 @@
+#ifndef TEXT_MODE_RUNS_H
+#define TEXT_MODE_RUNS_H
+#include "text_mode_kernel.h"
+
+#ifndef TEXT_MODE_BLANK_RUN_MIN_PIXELS
+/**
+ * Shortest span of blank cells worth sending as a color run.
+ * Each color run also splits the raw run around it, which costs about six halfwords of tokens,
+ * so very short spans are cheaper to just render.
+ */
+#define TEXT_MODE_BLANK_RUN_MIN_PIXELS 16
+#endif
+
+/**
+ * Renders a complete scan line as composable tokens, sending spans of cells whose glyphs are blank on
+ * this scan line and share a background color as a single COMPOSABLE_COLOR_RUN.
+ * Everything else is rendered by kernel into raw runs.
+ * Only the part of the row in the buffer's view is rendered.
+ * This needs the font to have blank_rows metadata; without it, the whole line is one raw run.
+ * The end-of-line token is not written.
+ * @param write Write pointer for the first token
+ * @param scanline Scanline number
+ * @param screen Pointer to text_buffer with page of text to display
+ * @param font Pointer to font to use for rendering
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @param kernel Routine that renders the cells in between blank spans
+ * @return Write pointer after the last token
+ */
+uint16_t* text_mode_generate_line_runs(uint16_t* write, unsigned scanline, text_buffer* screen,
+    const text_mode_font* font, const uint16_t* palette, text_mode_cells_kernel kernel);
+
+/**
+ * Renders a spacing line below a text row (see text_buffer.line_spacing) as composable tokens.
+ * Each span of cells with the same background color becomes a single COMPOSABLE_COLOR_RUN,
+ * so with TEXT_MODE_GLYPH_ONLY_CELLS, or any row with a single background, the whole line is one token.
+ * Only the part of the row in the buffer's view is rendered.
+ * The end-of-line token is not written.
+ * @param write Write pointer for the first token
+ * @param screen Pointer to text_buffer with page of text to display
+ * @param font Font the buffer is rendered with; a row with its own font (see text_buffer.row_fonts) uses that
+ * @param row Text row the spacing line is below
+ * @param palette Palette to decode colors with; ignored unless TEXT_MODE_PALETTIZED_COLOR is set
+ * @return Write pointer after the last token
+ */
+uint16_t* text_mode_generate_spacing_line(uint16_t* write, text_buffer* screen, const text_mode_font* font,
+    unsigned row, const uint16_t* palette);
+
+#endif /* TEXT_MODE_RUNS_H */
@@ -0,0 +1,26 @@
+#include "text_mode_sprite.h"
+
+
+void __not_in_flash_func(text_mode_sprite_draw)(uint16_t* line, const uint16_t* end, const text_mode_sprite* sprite,
+    unsigned scanline)
+{
+    if (!text_mode_sprite_on_line(sprite, scanline))
+        return;
+    unsigned row = scanline - sprite->position.y;
+    uint32_t mask = sprite->mask[row];
+    uint32_t image = sprite->image[row];
+    int x = sprite->position.x;
+    if (x < 0) {
+        // Shift the pixels left of the screen out of the top of the row.
+        if (x <= -TEXT_MODE_SPRITE_SIZE)
+            return;
+        mask = (mask << -x) & 0xFFFFu;
+        image <<= -x;
+        x = 0;
+    }
+    uint16_t foreground = sprite->foreground;
+    uint16_t background = sprite->background;
+    for (uint16_t* write = line + x; mask && write < end; write++, mask = (mask << 1) & 0xFFFFu, image <<= 1)
+        if (mask & 0x8000u)
+            *write = image & 0x8000u ? foreground : background;
+}
@@ -0,0 +1,56 @@
+#ifndef TEXT_MODE_SPRITE_H
+#define TEXT_MODE_SPRITE_H
+#include "pico.h"
+#include "coord.h"
+
+/** Widest and tallest a text_mode_sprite can be, in pixels. */
+#define TEXT_MODE_SPRITE_SIZE 16
+
+/**
+ * A small 1-bit image drawn over the screen at any pixel position, such as a mouse pointer.
+ * It's composited into each scan line it covers after the line is rendered, so the text underneath
+ * is never touched, and moving it is just changing position.
+ * This is read once per scan line, so it can be moved at any time; at worst a frame shows
+ * part of it in its old place.
+ */
+typedef struct text_mode_sprite
+{
+    /** Screen position of the top left pixel, which may be partly or entirely off screen. */
+    coord position;
+    /** Number of rows in image and mask, up to TEXT_MODE_SPRITE_SIZE. */
+    unsigned char height;
+    /** Pixel value drawn where the image bit is set. */
+    uint16_t foreground;
+    /** Pixel value drawn where the image bit is clear, such as for an outline. */
+    uint16_t background;
+    /** Each row of pixels, with the leftmost pixel in the most significant bit. */
+    const uint16_t* image;
+    /** Each row's mask, in the same order; only pixels whose mask bit is set are drawn. */
+    const uint16_t* mask;
+} text_mode_sprite;
+
+/**
+ * Returns true if a scan line of the screen shows any of the sprite.
+ * The render loop uses this to send the line as one raw run that the sprite can be drawn into.
+ * @param sprite Sprite to draw, or NULL for none
+ * @param scanline Scanline number
+ */
+static inline bool text_mode_sprite_on_line(const text_mode_sprite* sprite, unsigned scanline)
+{
+    // A sprite above the line wraps around to a huge row number.
+    return sprite && scanline - sprite->position.y < sprite->height;
+}
+
+/**
+ * Draws the sprite over a scan line that has already been rendered.
+ * This touches at most TEXT_MODE_SPRITE_SIZE pixels and loops once for each mask bit up to the last set one,
+ * so its cost on a line is bounded no matter what the line shows, and lines the sprite doesn't cover
+ * only pay text_mode_sprite_on_line().
+ * @param line First pixel of the scan line, which is the screen's leftmost pixel
+ * @param end End of the scan line's pixels; nothing is drawn past it
+ * @param sprite Sprite to draw, or NULL for none
+ * @param scanline Scanline number the line was rendered for
+ */
+void text_mode_sprite_draw(uint16_t* line, const uint16_t* end, const text_mode_sprite* sprite, unsigned scanline);
+
+#endif /* TEXT_MODE_SPRITE_H */
@@ -0,0 +1,119 @@
+#include "text_mode_style.h"
+
+
+/**
+ * Internal routine: Converts a cell color into a 16-bit pixel value.
+ */
+static inline uint16_t text_mode_style_color(text_color color, const uint16_t* palette)
+{
+#if TEXT_MODE_PALETTIZED_COLOR
+    return palette[color];
+#else
+    (void)palette;
+    return color;
+#endif
+}
+
+
+/**
+ * Internal routine: Works out which scan line of the font font_row points at.
+ */
+static inline unsigned text_mode_style_scan_line(const void* font_row, const text_mode_font* font)
+{
+    return ((const unsigned char*)font_row - (const unsigned char*)font->data) / font->scan_line_stride;
+}
+
+
+/**
+ * Internal routine: Works out the pixel values and glyph bits a styled cell is drawn with.
+ * @param line_mask From text_mode_style_line_mask() for the scan line being drawn
+ */
+static inline uint32_t text_mode_style_cell(const text_cell* cell, unsigned line_mask, const void* font_row,
+    const text_mode_font* font, const uint16_t* palette, color_pair colors, uint16_t* foreground,
+    uint16_t* background)
+{
+    unsigned style = text_cell_style(cell);
+    color_pair cell_colors = text_mode_style_colors(cell, colors);
+    uint16_t pixel = text_mode_style_color(cell_colors.foreground, palette);
+    if (style & TEXT_STYLE_HALF_BRIGHT)
+        pixel = text_mode_half_bright(pixel);
+    // Only the low 16 bits of BASE1 get stored, which is where the embiggener leaks through.
+    *foreground = pixel + TEXT_MODE_EMBIGGENER;
+    *background = text_mode_style_color(cell_colors.background, palette);
+    if (style & line_mask)
+        return 0xFFFFFFFFu;
+    return text_mode_font_bits(font, (const unsigned char*)font_row + cell->glyph * font->bytes_per_glyph);
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_style_generate_cells)(uint16_t* write, const text_cell* cells,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel)
+{
+    const text_cell* end = cells + count;
+    const text_cell* plain = cells;
+    unsigned line_mask = 0;
+    bool have_mask = false;
+    unsigned pixels = font->scan_pixels;
+    for (const text_cell* cell = cells; cell < end; cell++) {
+        if (!text_cell_style(cell))
+            continue;
+        if (plain != cell)
+            write = kernel(write, plain, cell - plain, font_row, font, palette, colors);
+        plain = cell + 1;
+        if (!have_mask) {
+            line_mask = text_mode_style_line_mask(font, text_mode_style_scan_line(font_row, font));
+            have_mask = true;
+        }
+        uint16_t foreground, background;
+        uint32_t bits = text_mode_style_cell(cell, line_mask, font_row, font, palette, colors, &foreground,
+            &background);
+        // The leftmost pixel is the most significant bit.
+        for (unsigned bit = pixels; bit > 0; bit--)
+            *write++ = (bits >> (bit - 1)) & 1 ? foreground : background;
+    }
+    if (plain != end)
+        write = kernel(write, plain, end - plain, font_row, font, palette, colors);
+    return write;
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_style_generate_cells_pair)(uint16_t* write0, uint16_t* write1,
+    const text_cell* cells, unsigned count, const void* font_row, const text_mode_font* font,
+    const uint16_t* palette, color_pair colors, text_mode_cells_pair_kernel kernel)
+{
+    const text_cell* end = cells + count;
+    const text_cell* plain = cells;
+    const void* font_row1 = (const unsigned char*)font_row + font->scan_line_stride;
+    unsigned line_mask0 = 0, line_mask1 = 0;
+    bool have_mask = false;
+    unsigned pixels = font->scan_pixels;
+    for (const text_cell* cell = cells; cell < end; cell++) {
+        if (!text_cell_style(cell))
+            continue;
+        if (plain != cell) {
+            uint16_t* next = kernel(write0, write1, plain, cell - plain, font_row, font, palette, colors);
+            write1 += next - write0;
+            write0 = next;
+        }
+        plain = cell + 1;
+        if (!have_mask) {
+            unsigned scan_line = text_mode_style_scan_line(font_row, font);
+            line_mask0 = text_mode_style_line_mask(font, scan_line);
+            line_mask1 = text_mode_style_line_mask(font, scan_line + 1);
+            have_mask = true;
+        }
+        uint16_t foreground, background;
+        uint32_t bits0 = text_mode_style_cell(cell, line_mask0, font_row, font, palette, colors, &foreground,
+            &background);
+        uint32_t bits1 = text_mode_style_cell(cell, line_mask1, font_row1, font, palette, colors, &foreground,
+            &background);
+        for (unsigned bit = pixels; bit > 0; bit--) {
+            *write0++ = (bits0 >> (bit - 1)) & 1 ? foreground : background;
+            *write1++ = (bits1 >> (bit - 1)) & 1 ? foreground : background;
+        }
+    }
+    if (plain != end)
+        write0 = kernel(write0, write1, plain, end - plain, font_row, font, palette, colors);
+    return write0;
+}
@@ -0,0 +1,93 @@
+#ifndef TEXT_MODE_STYLE_H
+#define TEXT_MODE_STYLE_H
+#include "text_mode_kernel.h"
+
+#ifndef PICO_SCANVIDEO_PIXEL_RSHIFT
+/* Same defaults as scanvideo's RGB555. */
+#define PICO_SCANVIDEO_PIXEL_RSHIFT 0
+#define PICO_SCANVIDEO_PIXEL_RCOUNT 5
+#define PICO_SCANVIDEO_PIXEL_GSHIFT 6
+#define PICO_SCANVIDEO_PIXEL_GCOUNT 5
+#define PICO_SCANVIDEO_PIXEL_BSHIFT 11
+#define PICO_SCANVIDEO_PIXEL_BCOUNT 5
+#endif
+
+/** Bits of a pixel value that belong to a color channel, and the channel's most significant bit. */
+#define TEXT_MODE_CHANNEL_BITS(shift, count) (((1u << (count)) - 1) << (shift))
+#define TEXT_MODE_CHANNEL_TOP(shift, count) (1u << ((shift) + (count) - 1))
+
+#ifndef TEXT_MODE_HALF_BRIGHT_MASK
+/**
+ * Bits kept after shifting a pixel value right by one to halve its brightness.
+ * Each channel loses the bit that shifted down into it from the channel above,
+ * and anything that isn't a color channel is cleared.
+ */
+#define TEXT_MODE_HALF_BRIGHT_MASK \
+    ((TEXT_MODE_CHANNEL_BITS(PICO_SCANVIDEO_PIXEL_RSHIFT, PICO_SCANVIDEO_PIXEL_RCOUNT) \
+        | TEXT_MODE_CHANNEL_BITS(PICO_SCANVIDEO_PIXEL_GSHIFT, PICO_SCANVIDEO_PIXEL_GCOUNT) \
+        | TEXT_MODE_CHANNEL_BITS(PICO_SCANVIDEO_PIXEL_BSHIFT, PICO_SCANVIDEO_PIXEL_BCOUNT)) \
+    & ~(TEXT_MODE_CHANNEL_TOP(PICO_SCANVIDEO_PIXEL_RSHIFT, PICO_SCANVIDEO_PIXEL_RCOUNT) \
+        | TEXT_MODE_CHANNEL_TOP(PICO_SCANVIDEO_PIXEL_GSHIFT, PICO_SCANVIDEO_PIXEL_GCOUNT) \
+        | TEXT_MODE_CHANNEL_TOP(PICO_SCANVIDEO_PIXEL_BSHIFT, PICO_SCANVIDEO_PIXEL_BCOUNT)))
+#endif
+
+/**
+ * Returns a pixel value at half brightness.
+ */
+static inline uint16_t text_mode_half_bright(uint16_t pixel)
+{
+    return (pixel >> 1) & TEXT_MODE_HALF_BRIGHT_MASK;
+}
+
+/**
+ * Returns the colors a cell is drawn in after TEXT_STYLE_INVERSE, which is also what its blank pixels and
+ * spacing lines show.
+ * TEXT_STYLE_HALF_BRIGHT is left out, since it only applies to pixel values.
+ * @param colors Colors of the cell's row, from text_buffer_row_colors()
+ */
+static inline color_pair text_mode_style_colors(const text_cell* cell, color_pair colors)
+{
+    colors = text_cell_colors(cell, colors);
+    if (text_cell_style(cell) & TEXT_STYLE_INVERSE)
+        return (color_pair){ colors.background, colors.foreground };
+    return colors;
+}
+
+/**
+ * Returns which of TEXT_STYLE_UNDERLINE and TEXT_STYLE_STRIKETHROUGH draw a solid line on a scan line of a font.
+ * The underline is the last scan line of the glyph, and the strikethrough is the middle one.
+ * A cell whose style has any of these bits has no blank pixels on that scan line.
+ */
+static inline unsigned text_mode_style_line_mask(const text_mode_font* font, unsigned scan_line)
+{
+    unsigned mask = 0;
+    if (scan_line == font->scan_lines - 1u)
+        mask |= TEXT_STYLE_UNDERLINE;
+    if (scan_line == font->scan_lines / 2u)
+        mask |= TEXT_STYLE_STRIKETHROUGH;
+    return mask;
+}
+
+/**
+ * Renders one scan line of a span of cells with their text_style bits applied.
+ * Spans of unstyled cells go to kernel unchanged, so plain text costs one extra check per cell;
+ * styled cells are rendered one at a time in C.
+ * The output for an unstyled cell is the same as kernel's, and a styled cell is drawn the same way the kernels
+ * draw a cell, embiggener and all, just with its colors and glyph bits changed.
+ * The parameters are the same as text_mode_cells_kernel's, plus the kernel to use.
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_style_generate_cells(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_kernel kernel);
+
+/**
+ * Two-line version of text_mode_style_generate_cells().
+ * The parameters are the same as text_mode_cells_pair_kernel's, plus the kernel to use.
+ * @return Returns modified write0; write1 advances the same amount
+ */
+uint16_t* text_mode_style_generate_cells_pair(uint16_t* write0, uint16_t* write1, const text_cell* cells,
+    unsigned count, const void* font_row, const text_mode_font* font, const uint16_t* palette, color_pair colors,
+    text_mode_cells_pair_kernel kernel);
+
+#endif /* TEXT_MODE_STYLE_H */
@@ -0,0 +1,60 @@
+#include "text_mode_tile.h"
+#include <string.h>
+
+/**
+ * Two adjacent pixels, stored with one word write.
+ * The left pixel is in the low half, since that's the lower address.
+ */
+typedef uint32_t __attribute__((may_alias)) text_mode_tile_pair;
+
+
+uint16_t* __not_in_flash_func(text_mode_tile_generate_cells)(uint16_t* write, const text_cell* cells,
+    unsigned count, const void* tile_row, const text_mode_font* font, const uint16_t* palettes, color_pair colors)
+{
+    const unsigned char* data = tile_row;
+    unsigned bytes_per_tile = text_mode_tile_bytes(font);
+    unsigned pairs = font->scan_pixels / 2;
+    bool odd = font->scan_pixels & 1;
+    for (const text_cell* cell = cells; count > 0; count--, cell++) {
+        const unsigned char* read = data + cell->glyph * bytes_per_tile;
+        const uint16_t* palette = palettes + 16 * text_cell_colors(cell, colors).foreground;
+        // Odd widths leave every other cell unaligned, and those store a pixel at a time.
+        if ((uintptr_t)write & 2) {
+            for (unsigned i = 0; i < pairs; i++, read++) {
+                *write++ = palette[*read >> 4];
+                *write++ = palette[*read & 15];
+            }
+        } else {
+            text_mode_tile_pair* pair = (text_mode_tile_pair*)write;
+            for (unsigned i = 0; i < pairs; i++, read++)
+                *pair++ = palette[*read >> 4] | (uint32_t)palette[*read & 15] << 16;
+            write = (uint16_t*)pair;
+        }
+        if (odd)
+            *write++ = palette[*read >> 4];
+    }
+    return write;
+}
+
+
+uint16_t* __not_in_flash_func(text_mode_tile_generate_line)(uint16_t* write, const text_cell* row,
+    const text_mode_clip* clip, const text_mode_tiles* tiles, unsigned char_row, const text_mode_font* font,
+    color_pair colors)
+{
+    const void* tile_row = text_mode_tile_row(tiles, font, char_row);
+    const text_cell* cell = row + clip->col;
+    uint16_t pixels[TEXT_MODE_MAX_FONT_WIDTH];
+    if (clip->head) {
+        text_mode_tile_generate_cells(pixels, cell - 1, 1, tile_row, font, tiles->palettes, colors);
+        memcpy(write, pixels + clip->skip, clip->head * sizeof(uint16_t));
+        write += clip->head;
+    }
+    if (clip->cols)
+        write = text_mode_tile_generate_cells(write, cell, clip->cols, tile_row, font, tiles->palettes, colors);
+    if (clip->tail) {
+        text_mode_tile_generate_cells(pixels, cell + clip->cols, 1, tile_row, font, tiles->palettes, colors);
+        memcpy(write, pixels, clip->tail * sizeof(uint16_t));
+        write += clip->tail;
+    }
+    return write;
+}
@@ -0,0 +1,91 @@
+#ifndef TEXT_MODE_TILE_H
+#define TEXT_MODE_TILE_H
+#include "text_mode_clip.h"
+
+/**
+ * A set of 4-bit color tiles that a row's glyphs index instead of the font, for icon grids and dashboards
+ * that need more than two colors a cell, at the cost of tile RAM rather than a framebuffer.
+ * Tiles have the geometry of the font the row is drawn in: font->scan_pixels wide and font->scan_lines high.
+ * Each cell's foreground color is the number of its sub-palette, which is 16 pixel values from palettes
+ * that go straight to scanvideo, so they aren't decoded by the text palette; the background is only used
+ * for spacing lines. Text styles aren't drawn on tiles.
+ */
+typedef struct text_mode_tiles
+{
+    /**
+     * Pixels of every tile, one after another, each one line after another,
+     * with text_mode_tile_line_bytes() per line and the leftmost pixel in the high nibble of each byte.
+     */
+    const void* data;
+    /** Sub-palettes of 16 pixel values each, one after another. */
+    const uint16_t* palettes;
+} text_mode_tiles;
+
+/**
+ * Returns the bytes in each line of a tile for a font, which is two pixels a byte, rounded up.
+ */
+static inline unsigned text_mode_tile_line_bytes(const text_mode_font* font)
+{
+    return (font->scan_pixels + 1) / 2;
+}
+
+/**
+ * Returns the bytes in each tile for a font.
+ */
+static inline unsigned text_mode_tile_bytes(const text_mode_font* font)
+{
+    return text_mode_tile_line_bytes(font) * font->scan_lines;
+}
+
+/**
+ * Returns the tiles a text row is drawn from, which is its entry in the buffer's row_tiles with
+ * TEXT_MODE_TILE_ROWS, or NULL to draw it as text.
+ * Double size rows are always drawn as text.
+ */
+static inline const text_mode_tiles* text_mode_row_tiles(const text_buffer* screen, unsigned row)
+{
+#if TEXT_MODE_TILE_ROWS
+    if (screen->row_tiles && !text_buffer_row_size(screen, row))
+        return screen->row_tiles[row];
+#else
+    (void)screen;
+    (void)row;
+#endif
+    return NULL;
+}
+
+/**
+ * Renders one scan line of a span of tile cells.
+ * This has the same signature as text_mode_cells_kernel, with tiles in place of a font.
+ * Pixels are stored two to a word from each byte of the tile when write is word-aligned.
+ * @param tile_row Line of tile 0 to render, from text_mode_tile_row()
+ * @param font Font the row is drawn in, which gives the tiles' geometry
+ * @param palettes Sub-palettes from text_mode_tiles
+ * @param colors Colors of every cell, from text_buffer_row_colors(); ignored unless TEXT_MODE_GLYPH_ONLY_CELLS is set
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_tile_generate_cells(uint16_t* write, const text_cell* cells, unsigned count,
+    const void* tile_row, const text_mode_font* font, const uint16_t* palettes, color_pair colors);
+
+/**
+ * Returns the line of tile 0 to render for a glyph line of a row, to pass to text_mode_tile_generate_cells().
+ */
+static inline const void* text_mode_tile_row(const text_mode_tiles* tiles, const text_mode_font* font,
+    unsigned char_row)
+{
+    return (const unsigned char*)tiles->data + char_row * text_mode_tile_line_bytes(font);
+}
+
+/**
+ * Renders one glyph line of the part of a tile row a clip shows, the way text_mode_clip_generate_cells()
+ * renders text, with the cells cut off by the view rendered into a scratch buffer.
+ * @param row First cell of the text row
+ * @param char_row Glyph line of the row, less than font->scan_lines
+ * @param font Font the row is drawn in, from text_mode_row_font()
+ * @param colors Colors of every cell, from text_buffer_row_colors(); ignored unless TEXT_MODE_GLYPH_ONLY_CELLS is set
+ * @return Returns modified write pointer
+ */
+uint16_t* text_mode_tile_generate_line(uint16_t* write, const text_cell* row, const text_mode_clip* clip,
+    const text_mode_tiles* tiles, unsigned char_row, const text_mode_font* font, color_pair colors);
+
+#endif /* TEXT_MODE_TILE_H */
@@ -11,6 +11,9 @@ void text_window_ctor_in_place(text_window* self, text_buffer* parent, coord loc
     self->colors = parent->colors;
     self->blank = parent->blank;
     self->font = parent->font;
+#if TEXT_MODE_CELL_STYLES
+    self->style = parent->style;
+#endif
 }
 
 
@@ -26,11 +29,7 @@ text_window* text_window_ctor(text_buffer* parent, coord location, coord size)
 static void text_window_clear_eol(text_window* self)
 {
     text_cell* cell = text_window_cursor(self);
-    text_cell empty = {
-        .glyph = ' ',
-        .foreground = self->colors.foreground,
-        .background = self->colors.background
-    };
+    text_cell empty = TEXT_CELL_INIT(' ', self->colors.foreground, self->colors.background);
     for (unsigned i = self->size.x - self->cursor.x; i > 0; i--)
         *cell++ = empty;
 }
@@ -72,29 +71,33 @@ void text_window_scroll_down_lines(text_window* self, unsigned n)
     size_t size = sizeof(text_cell) * self->size.x;
     for (unsigned i = 0; i < self->size.y - n; i++, line += delta)
         memcpy(line, line + delta * n, size);
-    text_cell empty = {
-        .glyph = self->blank,
-        .foreground = self->colors.foreground,
-        .background = self->colors.background
-    };
+    text_cell empty = TEXT_CELL_INIT(self->blank, self->colors.foreground, self->colors.background);
     for (unsigned i = 0; i < n; i++, line += self->parent->size.x - self->size.x)
         for (unsigned j = 0; j < self->size.x; j++)
             *line++ = empty;
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    // Row colors belong to whole rows of the buffer, so only a window as wide as the buffer takes them along.
+    if (self->parent->row_colors && self->location.x == 0 && self->size.x == self->parent->size.x) {
+        color_pair* colors = self->parent->row_colors + self->location.y;
+        memmove(colors, colors + n, (self->size.y - n) * sizeof(color_pair));
+        text_buffer_set_row_colors(self->parent, self->location.y + self->size.y - n, n, self->colors);
+    }
+#endif
 }
 
 
 void text_window_erase(text_window* self)
 {
-    text_cell empty = {
-        .glyph = self->blank,
-        .foreground = self->colors.foreground,
-        .background = self->colors.background
-    };
+    text_cell empty = TEXT_CELL_INIT(self->blank, self->colors.foreground, self->colors.background);
     text_cell* cell = text_window_cell(self, 0, 0);
     ptrdiff_t delta = self->parent->size.x - self->size.x;
     for (unsigned row = 0; row < self->size.y; row++, cell += delta)
         for (unsigned col = 0; col < self->size.x; col++)
             *cell++ = empty;
+#if TEXT_MODE_GLYPH_ONLY_CELLS
+    if (self->parent->row_colors)
+        text_buffer_set_row_colors(self->parent, self->location.y, self->size.y, self->colors);
+#endif
 }
 
 
@@ -193,8 +196,8 @@ static bool text_window_put_spaces(text_window* self, word_wrap* state)
             text_cell* cell = state->cell;
             cell->char_font.character = ' ';
             cell->char_font.font_id = self->font;
-            cell->foreground = self->colors.foreground;
-            cell->background = self->colors.background;
+            text_cell_set_colors(cell, self->colors);
+            text_cell_set_style(cell, text_window_style(self));
             state->cell++;
             self->cursor.x++;
         } else {
@@ -230,8 +233,8 @@ static bool text_window_put_word(text_window* self, word_wrap* state)
                 cell = state->cell;
                 cell->char_font.character = ch;
                 cell->char_font.font_id = self->font;
-                cell->foreground = self->colors.foreground;
-                cell->background = self->colors.background;
+                text_cell_set_colors(cell, self->colors);
+                text_cell_set_style(cell, text_window_style(self));
                 state->cell++;
                 self->cursor.x++;
                 state->str++;
@@ -356,8 +359,8 @@ static void text_window_clear_run(text_window* self, size_t n)
     text_cell* cell = text_window_cursor(self);
     while (n --> 0) {
         cell->glyph = self->blank;
-        cell->foreground = self->colors.foreground;
-        cell->background = self->colors.background;
+        text_cell_set_colors(cell, self->colors);
+        text_cell_set_style(cell, text_window_style(self));
         cell++;
         self->cursor.x++;
     }
@@ -23,6 +23,10 @@ typedef struct text_window
     text_glyph blank;
     /** Current font ID for writing text. */
     unsigned char font;
+#if TEXT_MODE_CELL_STYLES
+    /** Current text_style bits for writing text. */
+    unsigned char style;
+#endif
 } text_window;
 
 /**
@@ -62,6 +66,33 @@ static inline void text_window_set_colors(text_window* self, text_color foregrou
     self->colors.background = background;
 }
 
+/**
+ * Returns the text_style bits used for writing, which are always 0 without TEXT_MODE_CELL_STYLES.
+ */
+static inline unsigned text_window_style(const text_window* self)
+{
+#if TEXT_MODE_CELL_STYLES
+    return self->style;
+#else
+    (void)self;
+    return 0;
+#endif
+}
+
+/**
+ * Sets the text_style bits that will be used for writing.
+ * Does nothing without TEXT_MODE_CELL_STYLES.
+ */
+static inline void text_window_set_style(text_window* self, unsigned style)
+{
+#if TEXT_MODE_CELL_STYLES
+    self->style = style;
+#else
+    (void)self;
+    (void)style;
+#endif
+}
+
 /**
  * Returns a pointer to the cell the cursor currently points to.
  */
@@ -159,6 +190,9 @@ void text_window_newline_no_scroll_clear(text_window* self);
 /**
  * Scrolls the text_window down some number of lines.
  * The cursor is not changed.
+ * With TEXT_MODE_GLYPH_ONLY_CELLS, if the parent buffer has row colors and the window spans its full width,
+ * the row colors scroll with the text and the new rows get the window's colors.
+ * A narrower window shares its rows' colors with the rest of the buffer, so it leaves them alone.
  */
 void text_window_scroll_down_lines(text_window* self, unsigned lines);
 
@@ -217,8 +251,8 @@ static inline void text_window_put_char(text_window* self, char ch)
     text_cell* cell = text_window_cursor_next_circular(self);
     cell->char_font.character = ch;
     cell->char_font.font_id = self->font;
-    cell->foreground = self->colors.foreground;
-    cell->background = self->colors.background;
+    text_cell_set_colors(cell, self->colors);
+    text_cell_set_style(cell, text_window_style(self));
 }
 
 /**
@@ -228,8 +262,8 @@ static inline void text_window_put_glyph(text_window* self, text_glyph ch)
 {
     text_cell* cell = text_window_cursor_next_circular(self);
     cell->glyph = ch;
-    cell->foreground = self->colors.foreground;
-    cell->background = self->colors.background;
+    text_cell_set_colors(cell, self->colors);
+    text_cell_set_style(cell, text_window_style(self));
 }
 
 /**
@@ -277,7 +311,11 @@ static inline void text_window_overwrite_glyph(text_window* self, text_glyph ch)
     text_window_cursor_next_circular(self)->glyph = ch;
 }
 
-/** Erases the entire buffer, using current colors. */
+/**
+ * Erases the entire window, using current colors.
+ * With TEXT_MODE_GLYPH_ONLY_CELLS, this also sets the colors of the rows the window covers,
+ * if the parent buffer has row colors.
+ */
 void text_window_erase(text_window* self);
 
 #endif /* TEXT_WINDOW_H */